@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * benchmark-host/adapter-bench.cpp
+ *
+ * Frames per second of the NeoPixelBus and OctoSK6812 adapters with and
+ * without shadow framebuffer, on stub drivers, for a frame of read-modify-write
+ * pixel operations as drawn by Fireworks or SprayColor.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/NeoPixelBusAdapter.hpp>
+#include <BlinkenAlgorithms/Strip/OctoSK6812Adapter.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace BlinkenAlgorithms;
+
+using NeoPixelBusStub = NeoPixelBus<NeoGrbwFeature, NeoEsp8266Dma800KbpsMethod>;
+
+//! per frame: clear, add ops colors at random positions, or every pixel once
+template <typename Strip>
+void bench(const char* name, Strip& strip, size_t frames, size_t ops) {
+    size_t size = strip.size();
+    std::vector<size_t> index(ops);
+    for (size_t i = 0; i < ops; ++i)
+        index[i] = random() % size;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames; ++f) {
+        strip.clear();
+        for (size_t i = 0; i < ops; ++i)
+            strip.addPixel(index[i], Color(f + i, 16, i, 0));
+        for (size_t i = 0; i < size; ++i)
+            strip.orPixel(i, Color(0, 0, 0, f));
+        strip.show();
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("%-20s %6zu pixels: %8.0f fps, %6.1f Mops/s\n",
+           name, size, frames / seconds,
+           (ops + 2 * size) * frames / seconds / 1e6);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [strip size] [frames] [ops per pixel]
+    size_t size = argc >= 2 ? atoi(argv[1]) : 480;
+    size_t frames = argc >= 3 ? atoi(argv[2]) : 5000;
+    size_t ops = (argc >= 4 ? atoi(argv[3]) : 4) * size;
+
+    {
+        NeoPixelBusStub driver(size);
+        NeoPixelBusAdapter<NeoPixelBusStub> strip(driver);
+        bench("NeoPixelBus", strip, frames, ops);
+    }
+    {
+        NeoPixelBusStub driver(size);
+        NeoPixelBusAdapter<NeoPixelBusStub, true> strip(driver);
+        bench("NeoPixelBus shadow", strip, frames, ops);
+    }
+    {
+        OctoSK6812 driver(size / 8);
+        OctoSK6812Adapter<OctoSK6812> strip(driver);
+        bench("OctoSK6812", strip, frames, ops);
+    }
+    {
+        OctoSK6812 driver(size / 8);
+        OctoSK6812Adapter<OctoSK6812, true> strip(driver);
+        bench("OctoSK6812 shadow", strip, frames, ops);
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * benchmark-host/delay-bench.cpp
+ *
+ * Jitter histogram of std::this_thread::sleep_for() against delay_micros(),
+ * which sleeps until delay_spin_margin() before the deadline and spins, with
+ * the default margin and with the one measured by calibrate_delay(). Run on
+ * the Pi to check that the calibrated margin covers its wakeup latency.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Control.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace BlinkenAlgorithms;
+
+bool g_terminate = false;
+size_t g_delay_factor = 1;
+
+//! delay rounds times, print the microseconds each woke after its deadline
+template <typename Delay>
+void bench(const char* name, size_t rounds, uint32_t usec, Delay delay) {
+    std::vector<uint64_t> late(rounds);
+    size_t hist[6] = { 0, 0, 0, 0, 0, 0 };
+    uint64_t sum = 0;
+
+    for (size_t r = 0; r < rounds; ++r) {
+        uint64_t start = micros64();
+        delay(usec);
+        uint64_t elapsed = micros64() - start;
+        late[r] = elapsed > usec ? elapsed - usec : 0;
+        sum += late[r];
+
+        // buckets < 5, 15, 45, 135, 405 us, and more
+        size_t b = 0;
+        for (uint64_t limit = 5; b < 5 && late[r] >= limit; limit *= 3)
+            ++b;
+        ++hist[b];
+    }
+    if (rounds == 0)
+        return;
+    std::sort(late.begin(), late.end());
+
+    printf("%-16s late mean %6.1f p50 %4u p99 %5u max %5u us |"
+           " <5 %zu <15 %zu <45 %zu <135 %zu <405 %zu more %zu\n",
+           name, double(sum) / rounds, unsigned(late[rounds / 2]),
+           unsigned(late[rounds * 99 / 100]), unsigned(late.back()),
+           hist[0], hist[1], hist[2], hist[3], hist[4], hist[5]);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [delay usec] [rounds] [timer slack nsec]
+    uint32_t usec = argc >= 2 ? atoi(argv[1]) : 750;
+    size_t rounds = argc >= 3 ? atoi(argv[2]) : 2000;
+    unsigned long slack = argc >= 4 ? atol(argv[3]) : 1000;
+
+    printf("%zu delays of %u us\n", rounds, usec);
+
+    bench("sleep_for", rounds, usec, [](uint32_t d) {
+              std::this_thread::sleep_for(std::chrono::microseconds(d));
+          });
+
+    bench("delay_micros", rounds, usec, [](uint32_t d) { delay_micros(d); });
+    printf("%-16s default spin margin %u us\n", "", delay_spin_margin());
+
+    if (!set_timer_slack(slack))
+        printf("set_timer_slack(%lu) failed\n", slack);
+    uint32_t margin = calibrate_delay();
+    bench("calibrated", rounds, usec, [](uint32_t d) { delay_micros(d); });
+    printf("%-16s calibrated spin margin %u us, timer slack %lu ns\n",
+           "", margin, slack);
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * benchmark-host/encode-bench.cpp
+ *
+ * Pixels per second of the APA102 color encoding: the former scalar code with
+ * divisions against APA102Encoder's table lookups and batch path.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/APA102Encoder.hpp>
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace BlinkenAlgorithms;
+
+//! scalar encoding formerly in PiSPI_APA102::setPixel()
+APAColor encode_scalar(const Color& color, const uint8_t* gamma) {
+    // combine RGBW to RGB
+    unsigned r = gamma[color.r], g = gamma[color.g], b = gamma[color.b];
+    r += gamma[color.w], g += gamma[color.w], b += gamma[color.w];
+    // try to transform color to RGB + brightness
+    const uint16_t mm = 0x1F;
+    unsigned m = (((std::max(std::max(r, g), b) + 1) * mm - 1) >> 8) + 1;
+    r = (mm * r + (m >> 1)) / m;
+    g = (mm * g + (m >> 1)) / m;
+    b = (mm * b + (m >> 1)) / m;
+    r = r > 255 ? 255 : r, g = g > 255 ? 255 : g;
+    b = b > 255 ? 255 : b, m = m > 31 ? 31 : m;
+    APAColor c;
+    c.r = r, c.g = g, c.b = b;
+    c.w = 0b11100000 | (0b00011111 & m);
+    return c;
+}
+
+//! run encoder over the colors rounds times and print pixels/s
+template <typename Encoder>
+void bench(const char* name, const std::vector<Color>& colors,
+           std::vector<APAColor>& out, size_t rounds, Encoder encoder) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r)
+        encoder(out.data(), colors.data(), colors.size());
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // checksum keeps the compiler from dropping the loops
+    unsigned sum = 0;
+    for (const APAColor& c : out)
+        sum += c.r + c.g + c.b + c.w;
+    printf("%-12s %8.2f Mpixels/s (checksum %u)\n",
+           name, colors.size() * rounds / seconds / 1e6, sum);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [pixels] [rounds]
+    size_t n = argc >= 2 ? atoi(argv[1]) : 480;
+    size_t rounds = argc >= 3 ? atoi(argv[2]) : 20000;
+
+    const uint8_t* gamma = LEDStripBase::gamma8_table();
+
+    std::vector<Color> colors(n);
+    for (size_t i = 0; i < n; ++i) {
+        colors[i] = Color(random(), random(), random(),
+                          random() % 4 == 0 ? random() : 0);
+    }
+
+    // the table encoder must reproduce the scalar results
+    size_t mismatch = 0;
+    for (unsigned v = 0; v < (1u << 24); v += 7) {
+        Color c(v >> 16, v >> 8, v, v * 31);
+        if (encode_scalar(c, gamma) != APA102Encoder::encode(c, gamma))
+            ++mismatch;
+    }
+    printf("mismatches against scalar encoding: %zu\n", mismatch);
+
+    std::vector<APAColor> out(n);
+
+    // other color orders permute the channels of the default BGR order
+    using FormatRGB = PixelFormatAPA102<PixelFormatRGB>;
+    std::vector<APAColor> rgb(n);
+    APA102Encoder::encode(out.data(), colors.data(), n, gamma);
+    APA102Encoder::encode<FormatRGB>(rgb.data(), colors.data(), n, gamma);
+    size_t misordered = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&rgb[i]);
+        if (p[0] != out[i].w || p[1] != out[i].r || p[2] != out[i].g ||
+            p[3] != out[i].b)
+            ++misordered;
+    }
+    printf("misordered RGB pixels: %zu\n", misordered);
+
+    bench("scalar", colors, out, rounds,
+          [gamma](APAColor* dst, const Color* src, size_t m) {
+              for (size_t i = 0; i < m; ++i)
+                  dst[i] = encode_scalar(src[i], gamma);
+          });
+    bench("table", colors, out, rounds,
+          [gamma](APAColor* dst, const Color* src, size_t m) {
+              for (size_t i = 0; i < m; ++i)
+                  dst[i] = APA102Encoder::encode(src[i], gamma);
+          });
+    bench("batch", colors, out, rounds,
+          [gamma](APAColor* dst, const Color* src, size_t m) {
+              APA102Encoder::encode(dst, src, m, gamma);
+          });
+    bench("batch RGB", colors, out, rounds,
+          [gamma](APAColor* dst, const Color* src, size_t m) {
+              APA102Encoder::encode<FormatRGB>(dst, src, m, gamma);
+          });
+
+    return mismatch == 0 && misordered == 0 ? 0 : 1;
+}
+
+/******************************************************************************/
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * benchmark-host/framebuffer-bench.cpp
+ *
+ * Cost per frame of drawing into PiSPI_APA102 with per-pixel setPixel() calls
+ * against drawing into a FramebufferStrip, which hands the frame to the strip
+ * with one setPixels() call in show(), on a mock spidev file.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+//! draw frames of read-modify-write and plain pixel writes, returns
+//! microseconds per frame
+template <typename Strip>
+double bench(Strip& strip, size_t frames) {
+    size_t size = strip.size();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < size; ++i)
+            strip.setPixel(i, Color(f + i, f, i));
+        for (size_t i = 0; i < size; i += 7)
+            strip.addPixel(i, Color(0, 0, 0, 16));
+        strip.show();
+    }
+    while (strip.busy())
+        usleep(100);
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count() * 1e6 / frames;
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [strip size] [frames]
+    size_t size = argc >= 2 ? atoi(argv[1]) : 480;
+    size_t frames = argc >= 3 ? atoi(argv[2]) : 2000;
+
+    char tmpl[] = "/tmp/framebuffer-bench-XXXXXX";
+    int fd = mkstemp(tmpl);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    for (bool async : { false, true }) {
+        double direct, buffered;
+        {
+            PiSPI_APA102<> strip(tmpl, size, -1, async);
+            direct = bench(strip, frames);
+        }
+        {
+            PiSPI_APA102<> base(tmpl, size, -1, async);
+            FramebufferStrip<PiSPI_APA102<> > strip(base);
+            buffered = bench(strip, frames);
+        }
+        printf("%-5s %zu pixels: setPixel %7.1f us/frame, "
+               "FramebufferStrip %7.1f us/frame\n",
+               async ? "async" : "sync", size, direct, buffered);
+    }
+    unlink(tmpl);
+
+    return 0;
+}
+
+/******************************************************************************/
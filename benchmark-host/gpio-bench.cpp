@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * benchmark-host/gpio-bench.cpp
+ *
+ * Toggles per second of a GPIO output pin with each GPIOPin backend. On hosts
+ * without GPIO only the in-memory stub is available.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Extra/PiGPIO.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace BlinkenAlgorithms;
+
+//! toggle pin through backend, as PiSPI_APA102 does around each transfer
+void bench(std::unique_ptr<GPIOBackend> backend, int pin, size_t toggles) {
+    const char* name = backend->name();
+    GPIOPin gpio;
+    if (!gpio.set_pin(pin, /* output */ true, std::move(backend))) {
+        printf("%-8s not available\n", name);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < toggles; ++i)
+        gpio.write(i & 1);
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("%-8s %12.0f toggles/s, %8.1f ns/toggle\n",
+           name, toggles / seconds, seconds * 1e9 / toggles);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [pin] [toggles]
+    int pin = argc >= 2 ? atoi(argv[1]) : 25;
+    size_t toggles = argc >= 3 ? atoi(argv[2]) : 1000000;
+
+    bench(std::unique_ptr<GPIOBackend>(new GPIOMem), pin, toggles);
+    bench(std::unique_ptr<GPIOBackend>(new GPIOChardev), pin, toggles);
+    // sysfs takes a syscall per toggle
+    bench(std::unique_ptr<GPIOBackend>(new GPIOSysfs), pin, toggles / 100);
+    bench(std::unique_ptr<GPIOBackend>(new GPIOStub), pin, toggles);
+
+    return 0;
+}
+
+/******************************************************************************/
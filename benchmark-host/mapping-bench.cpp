@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * benchmark-host/mapping-bench.cpp
+ *
+ * Mapping cost per logical pixel of MappedStrip's layout tables against the
+ * arithmetic remappers InterleaveStrip, RepeatStrip and the former dome
+ * strips, all drawing into Framebuffers, checking that they agree.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+#include <BlinkenAlgorithms/Strip/MappedStrip.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace BlinkenAlgorithms;
+
+//! the dome remapper formerly in LEDStripBase.hpp: writes the first segment
+//! and replicates it in bulk in show()
+template <typename BaseStrip>
+class FormerMultiDomeStrip : public LEDStripRefBase<BaseStrip>
+{
+public:
+    using Super = LEDStripRefBase<BaseStrip>;
+    using Super::base_;
+
+    FormerMultiDomeStrip(BaseStrip& base)
+        : Super(base) { }
+
+    size_t size() { return 300; }
+
+    void setPixel(size_t i, const Color& c) {
+        base_.setPixel(i, c);
+    }
+
+    void show() {
+        for (size_t s = 1; s < 5; ++s)
+            base_.copyPixels(s * 300, 0, 300);
+        base_.show();
+    }
+};
+
+//! the reversed dome remapper formerly in LEDStripBase.hpp
+template <typename BaseStrip>
+class FormerDomeFFTStrip : public LEDStripRefBase<BaseStrip>
+{
+public:
+    using Super = LEDStripRefBase<BaseStrip>;
+    using Super::base_;
+
+    FormerDomeFFTStrip(BaseStrip& base)
+        : Super(base) { }
+
+    size_t size() { return 260; }
+
+    void setPixel(size_t i, const Color& c) {
+        base_.setPixel(260 - 1 - i, c);
+    }
+
+    void show() {
+        for (size_t s = 1; s < 5; ++s)
+            base_.copyPixels(s * 300, 0, 260);
+        base_.show();
+    }
+};
+
+//! draw frames into strip, returns nanoseconds per logical pixel
+template <typename Strip>
+double bench(Strip& strip, size_t frames) {
+    size_t size = strip.size();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < size; ++i)
+            strip.setPixel(i, Color(f + i, i, f));
+        strip.show();
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / frames / size;
+}
+
+void print(const char* name, double former, double mapped, bool same) {
+    printf("%-12s former %6.2f ns/pixel, MappedStrip %6.2f ns/pixel%s\n",
+           name, former, mapped, same ? "" : "  OUTPUT DIFFERS");
+}
+
+bool equal(const Framebuffer& a, size_t offset, const Framebuffer& b,
+           size_t n) {
+    return memcmp(a.data(), b.data() + offset, n * sizeof(Color)) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [frames]
+    size_t frames = argc >= 2 ? atoi(argv[1]) : 20000;
+    bool ok = true;
+
+    {
+        Framebuffer plain(1200);
+        double direct = bench(plain, frames);
+        printf("%-12s direct %6.2f ns/pixel\n", "unmapped", direct);
+    }
+    {
+        Framebuffer fb0(300), fb1(300), fb2(300), fb3(300);
+        Framebuffer* fb[4] = { &fb0, &fb1, &fb2, &fb3 };
+        InterleaveStrip<Framebuffer, 4> former({ fb[0], fb[1], fb[2], fb[3] });
+        Framebuffer base(1200);
+        MappedStrip<Framebuffer, StripLayout<1200> > mapped(
+            base, InterleaveLayout<1200, 4>());
+
+        double t0 = bench(former, frames), t1 = bench(mapped, frames);
+        bool same = true;
+        for (size_t s = 0; s < 4; ++s)
+            same = same && equal(*fb[s], s * 300, base, 300);
+        print("interleave", t0, t1, same);
+        ok = ok && same;
+    }
+    {
+        Framebuffer fb0(1200), fb1(1200);
+        RepeatStrip<Framebuffer, 2> former(fb0);
+        MappedStrip<Framebuffer, StripLayout<600, 2> > mapped(
+            fb1, RepeatLayout<600, 2>());
+
+        double t0 = bench(former, frames), t1 = bench(mapped, frames);
+        bool same = equal(fb0, 0, fb1, 1200);
+        print("repeat", t0, t1, same);
+        ok = ok && same;
+    }
+    {
+        Framebuffer fb0(1500), fb1(1500);
+        FormerMultiDomeStrip<Framebuffer> former(fb0);
+        LEDMultiDomeStrip<Framebuffer> mapped(fb1);
+
+        double t0 = bench(former, frames), t1 = bench(mapped, frames);
+        bool same = equal(fb0, 0, fb1, 1500);
+        print("multi dome", t0, t1, same);
+        ok = ok && same;
+    }
+    {
+        Framebuffer fb0(1500), fb1(1500);
+        FormerDomeFFTStrip<Framebuffer> former(fb0);
+        LEDDomeFFTStrip<Framebuffer> mapped(fb1);
+
+        double t0 = bench(former, frames), t1 = bench(mapped, frames);
+        bool same = equal(fb0, 0, fb1, 1500);
+        print("dome fft", t0, t1, same);
+        ok = ok && same;
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/******************************************************************************/
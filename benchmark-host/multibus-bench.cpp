@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * benchmark-host/multibus-bench.cpp
+ *
+ * Throughput of PiSPI_APA102_MultiBus over an increasing number of mock
+ * spidev files, which take as long as the SPI clock would, checking that each
+ * file receives its segment's pixels.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102_MultiBus.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+//! color of logical pixel i in the final check frame
+Color check_color(size_t i) {
+    return Color(255, i / 256, i % 256);
+}
+
+//! whether the file ends with a full frame of pixels [first,first+size)
+bool check_segment(const std::string& path, size_t first, size_t size) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+
+    std::vector<uint8_t> frame(4, 0x00);
+    for (size_t i = 0; i < size; ++i) {
+        APAColor c = APA102Encoder::encode(
+            check_color(first + i), LEDStripBase::gamma8_table());
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&c);
+        frame.insert(frame.end(), p, p + sizeof(c));
+    }
+    frame.resize(frame.size() + (size / 2 + 7) / 8, 0xFF);
+
+    return data.size() >= frame.size() &&
+           std::equal(frame.begin(), frame.end(),
+                      data.end() - frame.size());
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [max buses] [segment size] [frames]
+    size_t max_buses = argc >= 2 ? atoi(argv[1]) : 4;
+    size_t segment_size = argc >= 3 ? atoi(argv[2]) : 1500;
+    size_t frames = argc >= 4 ? atoi(argv[3]) : 200;
+
+    PiSPI::mock_wire_time() = true;
+    bool ok = true;
+
+    for (size_t buses = 1; buses <= max_buses; ++buses) {
+        std::vector<std::string> paths;
+        for (size_t b = 0; b < buses; ++b) {
+            char tmpl[] = "/tmp/multibus-bench-XXXXXX";
+            int fd = mkstemp(tmpl);
+            if (fd < 0) {
+                perror("mkstemp");
+                return 1;
+            }
+            close(fd);
+            paths.push_back(tmpl);
+        }
+
+        {
+            PiSPI_APA102_MultiBus<> strip(paths, segment_size);
+            size_t size = strip.size();
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t f = 0; f < frames; ++f) {
+                for (size_t i = 0; i < size; ++i)
+                    strip.setPixel(i, Color(f + i, f, i));
+                strip.show();
+            }
+            while (strip.busy())
+                usleep(100);
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+            printf("%zu buses x %zu pixels: %8.0f fps, %6.1f Mpixels/s\n",
+                   buses, segment_size, frames / seconds,
+                   size * frames / seconds / 1e6);
+
+            // a black frame, then a check frame changing every pixel
+            strip.clear();
+            strip.show();
+            for (size_t i = 0; i < size; ++i)
+                strip.setPixel(i, check_color(i));
+            strip.show();
+            while (strip.busy())
+                usleep(100);
+        }
+
+        for (size_t b = 0; b < buses; ++b) {
+            if (!check_segment(paths[b], b * segment_size, segment_size)) {
+                printf("bus %zu did not receive its segment\n", b);
+                ok = false;
+            }
+            unlink(paths[b].c_str());
+        }
+    }
+
+    // a zero segment size is rejected instead of dividing by it
+    PiSPI_APA102_MultiBus<> empty({ "/dev/null" }, 0);
+    empty.setPixel(0, Color(255));
+    if (empty.size() != 0 || empty.num_buses() != 0) {
+        printf("zero segment size was accepted\n");
+        ok = false;
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/******************************************************************************/
@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * benchmark-host/pipeline-check.cpp
+ *
+ * PipelineStrip in front of PiSPI_APA102 on a mock spidev file: checks that the
+ * zero-copy path through begin_frame() sends the transformed frame, and
+ * compares its frame rate with copying through setPixelsRaw().
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/OutputPipeline.hpp>
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+//! PiSPI_APA102 without begin_frame(), taking the setPixelsRaw() path
+class CopyStrip
+{
+public:
+    explicit CopyStrip(PiSPI_APA102<>& base) : base_(base) { }
+
+    size_t size() const { return base_.size(); }
+    void show() { base_.show(); }
+    bool busy() const { return base_.busy(); }
+    uint8_t intensity() const { return base_.intensity(); }
+    size_t skipped_frames() const { return base_.skipped_frames(); }
+
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        base_.setPixelsRaw(first, colors, n);
+    }
+
+private:
+    PiSPI_APA102<>& base_;
+};
+
+//! draw frames, returns frames per second
+template <typename Strip>
+double bench(Strip& strip, size_t frames) {
+    size_t size = strip.size();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < size; ++i)
+            strip.setPixel(i, Color(f + i, f, i));
+        strip.show();
+    }
+    while (strip.busy())
+        usleep(100);
+    return frames / std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+//! whether the file ends with the pipeline's transform of strip's frame
+bool check_frame(const char* path, PipelineStrip<PiSPI_APA102<> >& strip) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+
+    size_t size = strip.size();
+    std::vector<Color> colors(size);
+    strip.pipeline().apply(colors.data(), strip.data(), size);
+
+    std::vector<uint8_t> frame(4, 0x00);
+    for (size_t i = 0; i < size; ++i) {
+        APAColor c = APA102Encoder::encode(
+            colors[i], LEDStripBase::linear8_table());
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&c);
+        frame.insert(frame.end(), p, p + sizeof(c));
+    }
+    frame.resize(frame.size() + (size / 2 + 7) / 8, 0xFF);
+
+    return data.size() >= frame.size() &&
+           std::equal(frame.begin(), frame.end(),
+                      data.end() - frame.size());
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [strip size] [frames]
+    size_t size = argc >= 2 ? atoi(argv[1]) : 480;
+    size_t frames = argc >= 3 ? atoi(argv[2]) : 2000;
+
+    char tmpl[] = "/tmp/pipeline-check-XXXXXX";
+    int fd = mkstemp(tmpl);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    bool ok;
+    for (bool async : { false, true }) {
+        PiSPI_APA102<> spi(tmpl, size, -1, async);
+
+        CopyStrip copy(spi);
+        PipelineStrip<CopyStrip> copy_strip(copy);
+        copy_strip.pipeline().set_white_balance(255, 200, 160);
+        double copy_fps = bench(copy_strip, frames);
+        size_t messages = spi.spi().messages();
+
+        PipelineStrip<PiSPI_APA102<> > strip(spi);
+        strip.pipeline().set_white_balance(255, 200, 160);
+        double zero_fps = bench(strip, frames);
+
+        printf("%-5s setPixelsRaw %8.0f fps, begin_frame %8.0f fps, "
+               "%zu SPI messages\n", async ? "async" : "sync",
+               copy_fps, zero_fps, spi.spi().messages() - messages);
+    }
+
+    // the mock writes from the start of the file
+    if (truncate(tmpl, 0) != 0) {
+        perror("truncate");
+        return 1;
+    }
+    {
+        PiSPI_APA102<> spi(tmpl, size);
+        PipelineStrip<PiSPI_APA102<> > strip(spi);
+        strip.pipeline().set_white_balance(255, 200, 160);
+        strip.pipeline().set_gamma(true);
+        for (size_t i = 0; i < size; ++i)
+            strip.setPixel(i, Color(random(), random(), random()));
+        strip.show();
+        ok = check_frame(tmpl, strip);
+    }
+    unlink(tmpl);
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+/******************************************************************************/
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * benchmark-host/spi-bench.cpp
+ *
+ * Frames per second and SPI messages per frame of PiSPI_APA102, by default
+ * against a temporary file standing in for the spidev device.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+//! show frames which change pixels [0,count) and print the rates
+void bench(const char* name, PiSPI_APA102<>& strip, size_t count,
+           size_t frames) {
+    size_t messages = strip.spi().messages();
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < count; ++i)
+            strip.setPixel(i, Color(f + i, f, i));
+        strip.show();
+    }
+    strip.wait();
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    printf("%-16s %6zu pixels: %9.0f fps, %.2f messages/frame\n",
+           name, count, frames / seconds,
+           double(strip.spi().messages() - messages) / frames);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [strip size] [frames] [spidev path]
+    size_t strip_size = argc >= 2 ? atoi(argv[1]) : 480;
+    size_t frames = argc >= 3 ? atoi(argv[2]) : 10000;
+
+    std::string path;
+    if (argc >= 4) {
+        path = argv[3];
+    }
+    else {
+        char tmpl[] = "/tmp/spi-bench-XXXXXX";
+        int fd = mkstemp(tmpl);
+        if (fd < 0) {
+            perror("mkstemp");
+            return 1;
+        }
+        close(fd);
+        path = tmpl;
+    }
+
+    {
+        PiSPI_APA102<> strip(path, strip_size);
+        PiSPI_APA102<> async_strip(path, strip_size, -1, /* async */ true);
+        if (!strip.spi().is_open() || !async_strip.spi().is_open())
+            return 1;
+        printf("%s, spidev bufsiz %zu\n",
+               strip.spi().is_mock() ? "mock device" : path.c_str(),
+               strip.spi().bufsiz());
+
+        bench("sync full", strip, strip_size, frames);
+        bench("sync partial", strip, strip_size / 4, frames);
+        bench("async full", async_strip, strip_size, frames);
+        bench("async partial", async_strip, strip_size / 4, frames);
+    }
+
+    if (argc < 4) {
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            printf("mock device received %.1f MiB\n",
+                   st.st_size / 1024.0 / 1024.0);
+        }
+        unlink(path.c_str());
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * benchmark-host/stub/NeoPixelBus.h
+ *
+ * Host stand-in for the NeoPixelBus library: keeps pixels packed in wire
+ * order like the real driver, but Show() only copies them.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BENCHMARK_STUB_NEOPIXELBUS_HEADER
+#define BENCHMARK_STUB_NEOPIXELBUS_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct RgbwColor {
+    uint8_t R, G, B, W;
+
+    RgbwColor(uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t w = 0)
+        : R(r), G(g), B(b), W(w) { }
+};
+
+//! GRBW byte order of SK6812 strips
+struct NeoGrbwFeature { };
+
+//! transmission method, ignored
+struct NeoEsp8266Dma800KbpsMethod { };
+
+template <typename Feature, typename Method>
+class NeoPixelBus
+{
+public:
+    explicit NeoPixelBus(size_t count)
+        : pixels_(count * 4), dma_(count * 4) { }
+
+    size_t PixelCount() const { return pixels_.size() / 4; }
+
+    bool CanShow() const { return true; }
+
+    void Show() {
+        memcpy(dma_.data(), pixels_.data(), pixels_.size());
+        ++shows_;
+    }
+
+    void SetPixelColor(size_t i, RgbwColor c) {
+        if (i >= PixelCount())
+            return;
+        uint8_t* p = &pixels_[i * 4];
+        p[0] = c.G, p[1] = c.R, p[2] = c.B, p[3] = c.W;
+    }
+
+    RgbwColor GetPixelColor(size_t i) const {
+        if (i >= PixelCount())
+            return RgbwColor();
+        const uint8_t* p = &pixels_[i * 4];
+        return RgbwColor(p[1], p[0], p[2], p[3]);
+    }
+
+    size_t shows() const { return shows_; }
+
+private:
+    //! pixels in wire order
+    std::vector<uint8_t> pixels_;
+
+    //! copy taken by Show()
+    std::vector<uint8_t> dma_;
+
+    size_t shows_ = 0;
+};
+
+#endif // !BENCHMARK_STUB_NEOPIXELBUS_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * benchmark-host/stub/OctoSK6812.h
+ *
+ * Host stand-in for the OctoSK6812 library: keeps the eight strips'
+ * pixels bit-transposed like the real driver's DMA buffer, but show() only
+ * copies them.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BENCHMARK_STUB_OCTOSK6812_HEADER
+#define BENCHMARK_STUB_OCTOSK6812_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class OctoSK6812
+{
+public:
+    explicit OctoSK6812(size_t strip_len)
+        : strip_len_(strip_len),
+          draw_(strip_len * 32), frame_(strip_len * 32) { }
+
+    size_t numPixels() const { return strip_len_ * 8; }
+
+    bool busy() const { return false; }
+
+    void show() {
+        memcpy(frame_.data(), draw_.data(), draw_.size());
+        ++shows_;
+    }
+
+    //! store one bit of the color in each of 32 bytes
+    void setPixel(size_t num, uint32_t color) {
+        if (num >= numPixels())
+            return;
+        uint8_t mask = 1 << (num / strip_len_);
+        uint8_t* p = &draw_[(num % strip_len_) * 32];
+        for (int bit = 31; bit >= 0; --bit, ++p) {
+            if (color & (uint32_t(1) << bit))
+                *p |= mask;
+            else
+                *p &= ~mask;
+        }
+    }
+
+    uint32_t getPixel(size_t num) const {
+        if (num >= numPixels())
+            return 0;
+        uint8_t mask = 1 << (num / strip_len_);
+        const uint8_t* p = &draw_[(num % strip_len_) * 32];
+        uint32_t color = 0;
+        for (int bit = 0; bit < 32; ++bit, ++p)
+            color = (color << 1) | ((*p & mask) ? 1 : 0);
+        return color;
+    }
+
+    size_t shows() const { return shows_; }
+
+private:
+    size_t strip_len_;
+
+    //! bit-transposed buffer written by setPixel()
+    std::vector<uint8_t> draw_;
+
+    //! copy taken by show()
+    std::vector<uint8_t> frame_;
+
+    size_t shows_ = 0;
+};
+
+#endif // !BENCHMARK_STUB_OCTOSK6812_HEADER
+
+/******************************************************************************/
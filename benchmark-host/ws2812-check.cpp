@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * benchmark-host/ws2812-check.cpp
+ *
+ * Round trip of PiSPI_WS2812 frames through a mock spidev file: decodes the
+ * SPI bitstream back into pixels and compares them with the strip.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Strip/PiSPI_WS2812.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+//! Decode the frame of count pixels at offset of the file and compare it
+//! with the strip. Returns whether it matches and ends the file.
+template <typename Format>
+bool check_frame(const PiSPI_WS2812<Format>& strip, const char* path,
+                 size_t offset, size_t count) {
+    using Strip = PiSPI_WS2812<Format>;
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+    size_t length = count * Strip::pixel_bytes() + strip.reset_bytes();
+    if (file.size() != offset + length) {
+        printf("frame has %zu bytes instead of %zu\n",
+               file.size() - offset, length);
+        return false;
+    }
+    const uint8_t* data = file.data() + offset;
+
+    for (size_t i = 0; i < count; ++i, data += Strip::pixel_bytes()) {
+        uint8_t raw[Format::bytes];
+        for (size_t b = 0; b < Format::bytes; ++b) {
+            const uint8_t* bits = data + b * WS2812Encoder::expansion;
+            if (!WS2812Encoder::valid(bits)) {
+                printf("pixel %zu: invalid bit pattern\n", i);
+                return false;
+            }
+            raw[b] = WS2812Encoder::decode(bits);
+        }
+        Color c = Format::decode(raw), expect = strip.getPixel(i);
+        // white is not sent to RGB strips
+        if (!Format::has_white)
+            expect.w = 0;
+        if (c.v != expect.v) {
+            printf("pixel %zu: decoded %08x, expected %08x\n",
+                   i, unsigned(c.v), unsigned(expect.v));
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < strip.reset_bytes(); ++i) {
+        if (data[i] != 0) {
+            printf("reset is not held low\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+//! send a full frame and a partial one, decoding each from the file
+template <typename Format>
+bool check(const char* name, size_t size) {
+    char tmpl[] = "/tmp/ws2812-check-XXXXXX";
+    int fd = mkstemp(tmpl);
+    if (fd < 0) {
+        perror("mkstemp");
+        return false;
+    }
+    close(fd);
+
+    bool ok;
+    {
+        using Strip = PiSPI_WS2812<Format>;
+        Strip strip(tmpl, size);
+        for (size_t i = 0; i < size; ++i)
+            strip.setPixel(i, Color(random(), random(), random(), random()));
+        strip.show();
+        ok = check_frame(strip, tmpl, 0, size);
+
+        // change one pixel: only the prefix up to it is sent again
+        size_t last = size / 3;
+        strip.setPixel(last, strip.getPixel(last).v ? Color(0)
+                       : Color(255, 255, 255, 255));
+        strip.show();
+        ok = ok && check_frame(
+            strip, tmpl, size * Strip::pixel_bytes() + strip.reset_bytes(),
+            last + 1);
+
+        printf("%-6s %5zu pixels, %zu SPI messages: %s\n", name, size,
+               strip.spi().messages(), ok ? "ok" : "FAILED");
+    }
+    unlink(tmpl);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [strip size]
+    size_t size = argc >= 2 ? atoi(argv[1]) : 1000;
+
+    bool ok = check<PixelFormatGRB>("GRB", size);
+    ok = check<PixelFormatGRBW>("GRBW", size) && ok;
+    return ok ? 0 : 1;
+}
+
+/******************************************************************************/
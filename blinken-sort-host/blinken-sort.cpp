@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * blinken-sort-host/blinken-sort.cpp
+ *
+ * Run the sorting and hashing animations on a Linux host without LEDs:
+ * headless at full speed for profiling, or previewed in the terminal.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Animation/RandomAlgorithm.hpp>
+#include <BlinkenAlgorithms/Strip/NullStrip.hpp>
+#include <BlinkenAlgorithms/Strip/TerminalStrip.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace BlinkenAlgorithms;
+
+bool g_terminate = false;
+size_t g_delay_factor = 0;
+
+template <typename LEDStrip>
+void run(LEDStrip& strip, size_t rounds) {
+    for (size_t r = 0; r < rounds; ++r)
+        RunRandomAlgorithmAnimation(strip);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [null|term] [rounds] [delay factor] [strip size]
+    bool terminal = argc >= 2 && std::string(argv[1]) == "term";
+    size_t rounds = argc >= 3 ? atoi(argv[2]) : 22;
+    g_delay_factor = argc >= 4 ? atoi(argv[3]) : (terminal ? 1000 : 0);
+    size_t strip_size = argc >= 5 ? atoi(argv[4]) : 5 * 96;
+
+    srandom(time(nullptr));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t shows;
+    if (terminal) {
+        TerminalStrip strip(strip_size);
+        run(strip, rounds);
+        shows = strip.shows();
+    }
+    else {
+        NullStrip strip(strip_size);
+        run(strip, rounds);
+        shows = strip.shows();
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("%zu rounds, %zu frames in %.2f s: %.0f fps\n",
+           rounds, shows, seconds, shows / seconds);
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -7,17 +7,23 @@
  ******************************************************************************/
 
 #include <BlinkenAlgorithms/Animation/RandomAlgorithm.hpp>
+#include <BlinkenAlgorithms/Extra/RealTime.hpp>
 #include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
 
 using namespace BlinkenAlgorithms;
 
-PiSPI_APA102 my_strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
+PiSPI_APA102<> my_strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
 
 bool g_terminate = false;
 size_t g_delay_factor = 1000;
 
 int main() {
     srandom(time(nullptr));
+    RealTime::configure_from_env(RealTime::Render);
+
+    // sort delays are a few hundred microseconds: sleep precisely
+    set_timer_slack(1000);
+    calibrate_delay();
 
     while (1) {
         RunRandomAlgorithmAnimation(my_strip);
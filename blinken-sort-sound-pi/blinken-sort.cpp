@@ -20,6 +20,7 @@
 
 #include <BlinkenAlgorithms/Extra/Font5x5.hpp>
 #include <BlinkenAlgorithms/Extra/MAX7219.hpp>
+#include <BlinkenAlgorithms/Extra/RealTime.hpp>
 
 #include <BlinkenAlgorithms/Animation/SortSound.hpp>
 
@@ -130,7 +131,7 @@ void RunRandomAlgorithm(LEDStrip& strip) {
 
 using namespace BlinkenAlgorithms;
 
-PiSPI_APA102 my_strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
+PiSPI_APA102<> my_strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
 
 bool g_terminate = false;
 size_t g_delay_factor = 1000;
@@ -273,6 +274,16 @@ void wait_millis(uint32_t msec) {
     OnDelay();
 }
 
+//! SDL audio callback: attaches SDL's audio thread to the RealTime profile
+void AudioCallback(void* udata, uint8_t* stream, int len) {
+    static bool attached = false;
+    if (!attached) {
+        RealTime::attach_self(RealTime::Audio);
+        attached = true;
+    }
+    SoundCallback(udata, stream, len);
+}
+
 void wait_forever() {
     while (true) {
         delay_micros(1000);
@@ -282,6 +293,7 @@ void wait_forever() {
 
 int main() {
     srandom(123456);
+    RealTime::configure_from_env(RealTime::Render);
 
     // ---[ Open USB Keyboard ]-------------------------------------------------
 
@@ -309,7 +321,7 @@ int main() {
     sdlaudiospec.format = AUDIO_S16SYS;
     sdlaudiospec.channels = 2;          // 1 = mono, 2 = stereo
     sdlaudiospec.samples = 1024;        // Good low-latency value for callback
-    sdlaudiospec.callback = SoundCallback;
+    sdlaudiospec.callback = AudioCallback;
     sdlaudiospec.userdata = nullptr;
 
     // Open the audio device, forcing the desired format
@@ -30,3 +30,10 @@ build_cmake blinken-sort-sound-pi
 build_platformio random-flux-esp8266
 build_platformio random-flux-teensy
 build_cmake random-flux-pi
+
+build_cmake spi-output-daemon-pi
+build_cmake pixel-receiver-pi
+
+build_cmake blinken-sort-host
+build_cmake random-flux-host
+build_cmake benchmark-host
@@ -15,6 +15,7 @@
 
 #include <cmath>
 #include <random>
+#include <vector>
 
 namespace BlinkenAlgorithms {
 
@@ -207,8 +208,7 @@ public:
         size_t strip_size = strip_.size();
         unsigned intensity = strip_.intensity();
 
-        for (size_t i = 0; i < strip_size; ++i)
-            strip_.setPixel(i, 0);
+        strip_.clear();
         strip_.show();
 
         for (uint32_t s = 0; s < 4000 / 80; ++s) {
@@ -218,9 +218,7 @@ public:
             strip_.show();
             delay(40);
 
-            for (size_t i = 0; i < strip_size; ++i) {
-                strip_.setPixel(i, Color(0));
-            }
+            strip_.clear();
             strip_.show();
             delay(40);
         }
@@ -241,8 +239,7 @@ public:
         size_t strip_size = strip_.size();
         unsigned intensity = strip_.intensity();
 
-        for (size_t i = 0; i < strip_size; ++i)
-            strip_.setPixel(i, 0);
+        strip_.clear();
         strip_.show();
 
         for (uint32_t r = 0; r < 3; ++r) {
@@ -253,9 +250,7 @@ public:
                 strip_.show();
                 delay(60);
 
-                for (size_t i = 0; i < strip_size; ++i) {
-                    strip_.setPixel(i, Color(0));
-                }
+                strip_.clear();
                 strip_.show();
                 delay(60);
             }
@@ -695,9 +690,7 @@ public:
             }
         }
 
-        for (size_t i = 0; i < strip_size; ++i) {
-            strip_.setPixel(i, 0);
-        }
+        strip_.clear();
         uint8_t intensity = strip_.intensity();
         for (size_t i = 0; i < free_; ++i) {
             Pixi& p = pixis_[i];
@@ -785,9 +778,7 @@ public:
             }
         }
 
-        for (size_t i = 0; i < strip_size; ++i) {
-            strip_.setPixel(i, 0);
-        }
+        strip_.clear();
         uint8_t intensity = strip_.intensity();
         for (size_t i = 0; i < pixis_.size(); ++i) {
             if (!pixis_[i].on)
@@ -851,8 +842,7 @@ struct KnightSnakes {
             sk.length = 8 + random(32);
         }
 
-        for (size_t i = 0; i < strip_size; ++i)
-            strip_.setPixel(i, 0);
+        strip_.clear();
 
         for (size_t i = 0; i < num_snakes; ++i) {
             Snake& sk = snakes_[i];
@@ -943,9 +933,7 @@ public:
             }
         }
 
-        for (size_t i = 0; i < strip_size; ++i) {
-            strip_.setPixel(i, 0);
-        }
+        strip_.clear();
         uint8_t intensity = strip_.intensity();
         for (size_t i = 0; i < pixis_.size(); ++i) {
             if (!pixis_[i].on)
@@ -1050,9 +1038,7 @@ public:
         size_t strip_size = strip_.size();
         unsigned intensity = strip_.intensity();
 
-        for (size_t i = 0; i < strip_size; ++i) {
-            strip_.setPixel(i, 0);
-        }
+        strip_.clear();
 
         Color colors[] = {
             Color(intensity, 0, 0),
@@ -1078,105 +1064,114 @@ public:
 
 /******************************************************************************/
 
+//! called with the number and timing statistics of each finished animation
+static void (* FluxStatsHook)(size_t a, const AnimationStats& stats) = nullptr;
+
 template <typename LEDStrip>
 void RunRandomFluxAnimations(LEDStrip& strip) {
     static const size_t time_limit = 20000;
 
     while (1) {
-        for (size_t i = 0; i < strip.size(); ++i)
-            strip.setPixel(i, 0);
+        strip.clear();
+
+        std::vector<AnimationStats> stats;
 
         size_t a = random(15);
         // a = 15;
         switch (a) {
         case 0:
-            RunAnimation(
-                ColorWipeRGBW<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                ColorWipeRGBW<LEDStrip>(strip));
             break;
         case 1:
-            RunAnimation(
-                ColorWipeTwoSine<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                ColorWipeTwoSine<LEDStrip>(strip));
             break;
         case 2:
-            RunAnimation(
-                WheelColorWheel<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                WheelColorWheel<LEDStrip>(strip));
             break;
         case 3:
-            RunAnimation(
-                HSVColorWheel<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                HSVColorWheel<LEDStrip>(strip));
             break;
 
         case 4:
-            RunAnimation(
+            stats = RunAnimation(
+                time_limit,
                 SparkleWhite<LEDStrip>(
                     strip, /* speed */ 3000, /* density */ 30,
-                    Color(strip.intensity())),
-                time_limit);
+                    Color(strip.intensity())));
             break;
         case 5:
-            RunAnimation(
+            stats = RunAnimation(
+                time_limit,
                 SparkleWhite<LEDStrip>(strip, /* speed */ 2000, /* density */ 5,
-                                       Color(strip.intensity())),
-                time_limit);
+                                       Color(strip.intensity())));
             break;
         case 6:
-            RunAnimation(
-                SparkleRGB<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                SparkleRGB<LEDStrip>(strip));
             break;
         case 7:
-            RunAnimation(
-                SparkleRGB<LEDStrip>(strip, /* speed */ 2000, /* density */ 5),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                SparkleRGB<LEDStrip>(strip, /* speed */ 2000, /* density */ 5));
             break;
 
         case 8:
-            RunAnimation(
-                Fire<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                Fire<LEDStrip>(strip));
             break;
         case 9:
-            RunAnimation(
-                FireIce<LEDStrip>(strip, /* color */ 0),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                FireIce<LEDStrip>(strip, /* color */ 0));
             break;
 
         case 10:
-            RunAnimation(
-                SprayColor<LEDStrip>(strip, /* reverse */ false),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                SprayColor<LEDStrip>(strip, /* reverse */ false));
             break;
         case 11:
-            RunAnimation(
-                SprayColor<LEDStrip>(strip, /* reverse */ true),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                SprayColor<LEDStrip>(strip, /* reverse */ true));
             break;
 
         case 12:
-            RunAnimation(
-                Fireworks<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                Fireworks<LEDStrip>(strip));
             break;
         case 13:
-            RunAnimation(
-                KnightSnakes<LEDStrip, /* TrueHSV */ true>(strip, 25000, 40),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                KnightSnakes<LEDStrip, /* TrueHSV */ true>(strip, 25000, 40));
             break;
         case 14:
-            RunAnimation(
-                PulseColor<LEDStrip>(strip),
-                time_limit);
+            stats = RunAnimation(
+                time_limit,
+                PulseColor<LEDStrip>(strip));
             break;
             // case 15:
             //     RunAnimation(
-            //         Starlight<LEDStrip>(strip),
-            //         time_limit);
+            //         time_limit,
+            //         Starlight<LEDStrip>(strip));
             //     break;
         }
+
+        if (FluxStatsHook) {
+            for (const AnimationStats& st : stats)
+                FluxStatsHook(a, st);
+        }
     }
 }
 
@@ -23,8 +23,7 @@ namespace BlinkenAlgorithms {
  */
 template <typename LEDStrip>
 void RunRandomAlgorithmAnimation(LEDStrip& strip) {
-    for (size_t i = 0; i < strip.size(); ++i)
-        strip.setPixel(i, 0);
+    strip.clear();
 
     using namespace BlinkenSort;
     using namespace BlinkenHashtable;
@@ -11,6 +11,7 @@
 
 #include <BlinkenAlgorithms/Color.hpp>
 #include <BlinkenAlgorithms/Control.hpp>
+#include <BlinkenAlgorithms/Trace.hpp>
 
 #include <cassert>
 #include <random>
@@ -179,8 +180,10 @@ static unsigned intensity_flash_high = 2;
 void Item::OnAccess(const Item* a, bool with_delay) {
     if (sort_animation_hook)
         sort_animation_hook->OnAccess(a, with_delay);
-    if (SoundAccessHook)
+    if (SoundAccessHook) {
+        BLINKEN_TRACE_SPAN("sound hook");
         SoundAccessHook(a->value_);
+    }
 }
 
 void Item::OnComparison(const Item& a, const Item& b) {
@@ -188,6 +191,7 @@ void Item::OnComparison(const Item& a, const Item& b) {
         sort_animation_hook->OnComparison(&a, &b);
     }
     if (SoundAccessHook) {
+        BLINKEN_TRACE_SPAN("sound hook");
         SoundAccessHook(a.value_);
         SoundAccessHook(b.value_);
     }
@@ -811,8 +815,10 @@ public:
     void IncrementCounter() {
         if (enable_count_)
             ++counter_value;
-        if (ComparisonCountHook)
+        if (ComparisonCountHook) {
+            BLINKEN_TRACE_SPAN("count hook");
             ComparisonCountHook(counter_value);
+        }
     }
 
     void OnComparison(const Item* a, const Item* b) override {
@@ -848,6 +854,7 @@ public:
     void yield_delay(int32_t delay_time) {
 
         if (delay_time > 0) {
+            BLINKEN_TRACE_SPAN("sleep");
             int32_t remain = delay_time;
             while (remain > 100000) {
                 delay_micros(100000);
@@ -855,8 +862,10 @@ public:
             }
             delay_micros(remain);
         }
-        if (DelayHook)
+        if (DelayHook) {
+            BLINKEN_TRACE_SPAN("delay hook");
             DelayHook();
+        }
 
         if (intensity_last != strip_.intensity()) {
             intensity_last = strip_.intensity();
@@ -913,7 +922,7 @@ public:
 
         if (frame_buffer_pos_ == 0) {
             if (!strip_.busy()) {
-                strip_.show();
+                show();
             }
 
             // reset pixels in this frame_buffer_pos_
@@ -938,7 +947,7 @@ public:
             flash_high(i);
 
             if (!strip_.busy())
-                strip_.show();
+                show();
 
             yield_delay();
 
@@ -958,7 +967,7 @@ public:
             flash_high(i), flash_high(j);
 
             if (!strip_.busy())
-                strip_.show();
+                show();
 
             yield_delay();
 
@@ -981,7 +990,7 @@ public:
         frame_buffer_pos_ = frame_drop_ - 1;
         yield_delay();
 
-        strip_.show();
+        show();
     }
 
 protected:
@@ -992,6 +1001,11 @@ protected:
 
     //! whether to count comparisons
     bool enable_count_;
+
+    void show() {
+        BLINKEN_TRACE_SPAN("show");
+        strip_.show();
+    }
 };
 
 template <typename LEDStrip>
@@ -1022,7 +1036,8 @@ void RunSort(LEDStrip& strip, const char* algo_name,
     ani.array_check();
     ani.pflush();
     // printf("%s check time: %.2f\n", algo_name, (millis() - ts) / 1000.0);
-    ani.yield_delay(2000000);
+    // pause on the sorted array, scaled like all other delays
+    ani.yield_delay(2000000 * g_delay_factor / 1000);
 }
 
 /******************************************************************************/
@@ -59,8 +59,8 @@ struct Color {
 
     Color operator + (const Color& c2) const {
         return Color(std::min(255, static_cast<uint16_t>(r) + c2.r),
-                     std::min(255, static_cast<uint16_t>(b) + c2.b),
                      std::min(255, static_cast<uint16_t>(g) + c2.g),
+                     std::min(255, static_cast<uint16_t>(b) + c2.b),
                      std::min(255, static_cast<uint16_t>(w) + c2.w));
     }
 };
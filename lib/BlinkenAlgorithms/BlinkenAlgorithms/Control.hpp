@@ -9,13 +9,22 @@
 #ifndef BLINKENALGORITHMS_CONTROL_HEADER
 #define BLINKENALGORITHMS_CONTROL_HEADER
 
+#include <cstdint>
 #include <cstdlib>
 
 #if ESP8266
 // no includes
 #else
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <thread>
+#include <vector>
+#endif
+
+#if !ESP8266 && !TEENSYDUINO
+#include <sys/prctl.h>
+#include <time.h>
 #endif
 
 extern bool g_terminate;
@@ -59,6 +68,67 @@ unsigned long micros() {
 #endif
 }
 
+//! Monotonic microseconds which do not wrap around, unlike the 32-bit
+//! micros() on microcontrollers which wraps after 71 minutes.
+static inline
+uint64_t micros64() {
+#if ESP8266
+    return ::micros64();
+#elif TEENSYDUINO
+    // extend the 32-bit counter, requires a call at least every 71 minutes
+    static uint32_t last = 0, high = 0;
+    uint32_t now = ::micros();
+    if (now < last)
+        ++high;
+    last = now;
+    return (uint64_t(high) << 32) | now;
+#else
+    // same clock as delay_until_micros64()
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+#if !ESP8266 && !TEENSYDUINO
+//! Microseconds before a deadline at which the precise delays stop sleeping
+//! and spin on the clock, covering the kernel's wakeup latency and timer
+//! slack. See calibrate_delay().
+static inline
+uint32_t& delay_spin_margin() {
+    static uint32_t margin = 100;
+    return margin;
+}
+#endif
+
+//! Sleep until the absolute micros64() time deadline. Unlike a relative
+//! delay, the time spent computing since the deadline was set does not add
+//! to the period. On Linux, sleeps with clock_nanosleep() until
+//! delay_spin_margin() before the deadline, then spins until it.
+static inline
+void delay_until_micros64(uint64_t deadline) {
+#if ESP8266 || TEENSYDUINO
+    uint64_t now = micros64();
+    if (deadline > now) {
+        uint64_t usec = deadline - now;
+#if ESP8266
+        ESP.wdtFeed();
+#endif
+        delayMicroseconds(usec < UINT32_MAX ? uint32_t(usec) : UINT32_MAX);
+    }
+#else
+    uint64_t wake = deadline - delay_spin_margin();
+    if (deadline > delay_spin_margin() && wake > micros64()) {
+        struct timespec ts;
+        ts.tv_sec = wake / 1000000;
+        ts.tv_nsec = (wake % 1000000) * 1000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)
+               == EINTR) { }
+    }
+    while (micros64() < deadline) { }
+#endif
+}
+
 static inline
 void delay_micros(uint32_t usec) {
 #if ESP8266
@@ -70,10 +140,42 @@ void delay_micros(uint32_t usec) {
         delayMicroseconds(usec);
 #else
     if (usec != 0)
-        std::this_thread::sleep_for(std::chrono::microseconds(usec));
+        delay_until_micros64(micros64() + usec);
 #endif
 }
 
+#if !ESP8266 && !TEENSYDUINO
+//! Set the thread's timer slack in nanoseconds, by which the kernel may
+//! defer wakeups to coalesce them. The default is 50 us.
+static inline
+bool set_timer_slack(unsigned long nsec) {
+    return prctl(PR_SET_TIMERSLACK, nsec, 0, 0, 0) == 0;
+}
+
+//! Measure how late clock_nanosleep() wakes up and set delay_spin_margin()
+//! to cover all but the worst percent of the rounds. Call after
+//! set_timer_slack(). Returns the margin in microseconds.
+static inline
+uint32_t calibrate_delay(size_t rounds = 200, uint32_t sleep_usec = 500) {
+    std::vector<uint64_t> late(rounds);
+    for (size_t r = 0; r < rounds; ++r) {
+        uint64_t deadline = micros64() + sleep_usec;
+        struct timespec ts;
+        ts.tv_sec = deadline / 1000000;
+        ts.tv_nsec = (deadline % 1000000) * 1000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)
+               == EINTR) { }
+        late[r] = micros64() - deadline;
+    }
+    std::sort(late.begin(), late.end());
+    // plus a few microseconds for the clock reads
+    uint32_t margin =
+        rounds == 0 ? delay_spin_margin() : late[rounds * 99 / 100] + 5;
+    delay_spin_margin() = margin;
+    return margin;
+}
+#endif
+
 static inline
 void delay_millis(uint32_t msec) {
     delay_micros(msec * 1000);
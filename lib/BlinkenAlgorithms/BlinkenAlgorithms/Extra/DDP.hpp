@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/DDP.hpp
+ *
+ * Packet format of the Distributed Display Protocol (DDP), which carries
+ * pixel data over UDP port 4048.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_DDP_HEADER
+#define BLINKENALGORITHMS_EXTRA_DDP_HEADER
+
+#include <cstddef>
+#include <cstdint>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * DDP header: flags, sequence number (1-15, 0 = unused), data type,
+ * destination id, 32-bit byte offset and 16-bit data length, both big endian.
+ * The push flag marks the last packet of a frame, which is then displayed.
+ */
+class DDP
+{
+public:
+    static const uint16_t port = 4048;
+
+    static const size_t header_size = 10;
+    //! header with the optional timecode
+    static const size_t header_size_timecode = 14;
+
+    //! largest payload which fits into a 1500 byte ethernet MTU
+    static const size_t max_data = 1440;
+
+    static const uint8_t flag_version1 = 0x40;
+    static const uint8_t flag_version_mask = 0xC0;
+    static const uint8_t flag_timecode = 0x10;
+    static const uint8_t flag_storage = 0x08;
+    static const uint8_t flag_reply = 0x04;
+    static const uint8_t flag_query = 0x02;
+    static const uint8_t flag_push = 0x01;
+
+    //! data types: 8-bit RGB and RGBW pixels
+    static const uint8_t type_rgb8 = 0x0B;
+    static const uint8_t type_rgbw8 = 0x1B;
+
+    //! destination id of the default output device
+    static const uint8_t id_display = 1;
+
+    struct Packet {
+        uint8_t flags;
+        uint8_t seq;
+        uint8_t type;
+        uint8_t id;
+        uint32_t offset;
+        uint16_t length;
+        const uint8_t* data;
+    };
+
+    //! parse packet, returns false if it is not a valid DDP data packet
+    static bool parse(const uint8_t* buf, size_t len, Packet& p) {
+        if (len < header_size)
+            return false;
+
+        p.flags = buf[0];
+        p.seq = buf[1] & 0x0F;
+        p.type = buf[2];
+        p.id = buf[3];
+        p.offset = (uint32_t(buf[4]) << 24) | (uint32_t(buf[5]) << 16) |
+                   (uint32_t(buf[6]) << 8) | buf[7];
+        p.length = (uint16_t(buf[8]) << 8) | buf[9];
+
+        size_t hdr = (p.flags & flag_timecode) ? size_t(header_size_timecode)
+                     : size_t(header_size);
+        if ((p.flags & flag_version_mask) != flag_version1 ||
+            (p.flags & (flag_query | flag_reply)) || len < hdr + p.length)
+            return false;
+
+        p.data = buf + hdr;
+        return true;
+    }
+
+    //! write a header without timecode, returns header_size
+    static size_t write_header(
+        uint8_t* buf, uint8_t flags, uint8_t seq, uint8_t type, uint8_t id,
+        uint32_t offset, uint16_t length) {
+        buf[0] = flag_version1 | flags;
+        buf[1] = seq & 0x0F;
+        buf[2] = type;
+        buf[3] = id;
+        buf[4] = offset >> 24, buf[5] = offset >> 16;
+        buf[6] = offset >> 8, buf[7] = offset;
+        buf[8] = length >> 8, buf[9] = length;
+        return header_size;
+    }
+
+    //! sequence number following seq, wrapping from 15 to 1
+    static uint8_t next_seq(uint8_t seq) {
+        return seq % 15 + 1;
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_DDP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/E131.hpp
+ *
+ * Packet format of ANSI E1.31 (streaming ACN, sACN): DMX universes of up to
+ * 512 channels over UDP port 5568.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_E131_HEADER
+#define BLINKENALGORITHMS_EXTRA_E131_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Data packets consist of root, framing and DMP layers, the channel data
+ * starts at offset 126. Synchronization packets of the extended root vector
+ * latch all universes which carry the same sync address.
+ */
+class E131
+{
+public:
+    static const uint16_t port = 5568;
+
+    static const size_t header_size = 126;
+    static const size_t max_channels = 512;
+    static const size_t max_packet = header_size + max_channels;
+    static const size_t sync_packet_size = 49;
+
+    static const uint8_t option_preview = 0x80;
+    static const uint8_t option_terminated = 0x40;
+
+    struct Packet {
+        //! synchronization packet, only seq and sync_address are valid
+        bool sync;
+        uint8_t seq;
+        uint16_t sync_address;
+        uint16_t universe;
+        uint8_t priority;
+        uint8_t options;
+        uint16_t length;
+        const uint8_t* data;
+    };
+
+    //! parse packet, returns false if it is not a DMX data or sync packet
+    static bool parse(const uint8_t* buf, size_t len, Packet& p) {
+        if (len < sync_packet_size || get16(buf) != 0x0010 ||
+            memcmp(buf + 4, acn_id(), 12) != 0)
+            return false;
+
+        uint32_t root_vector = get32(buf + 18);
+        if (root_vector == vector_root_extended &&
+            get32(buf + 40) == vector_extended_sync) {
+            p.sync = true;
+            p.seq = buf[44];
+            p.sync_address = get16(buf + 45);
+            return true;
+        }
+
+        if (len < header_size || root_vector != vector_root_data ||
+            get32(buf + 40) != vector_data || buf[117] != 0x02 ||
+            buf[125] != 0x00)
+            return false;
+
+        uint16_t count = get16(buf + 123);
+        if (count < 1 || header_size + count - 1 > len)
+            return false;
+
+        p.sync = false;
+        p.priority = buf[108];
+        p.sync_address = get16(buf + 109);
+        p.seq = buf[111];
+        p.options = buf[112];
+        p.universe = get16(buf + 113);
+        p.length = count - 1;
+        p.data = buf + header_size;
+        return true;
+    }
+
+    //! Write data packet header for n channels, the data follows at
+    //! header_size. Returns the packet size.
+    static size_t write_data_header(
+        uint8_t* buf, const uint8_t cid[16], const char* source,
+        uint16_t universe, uint8_t seq, uint16_t sync_address, size_t n) {
+        size_t len = header_size + n;
+        write_root(buf, cid, vector_root_data, len);
+        put16(buf + 38, 0x7000 | (len - 38));
+        put32(buf + 40, vector_data);
+        memset(buf + 44, 0, 64);
+        strncpy(reinterpret_cast<char*>(buf + 44), source, 63);
+        buf[108] = 100;
+        put16(buf + 109, sync_address);
+        buf[111] = seq;
+        buf[112] = 0;
+        put16(buf + 113, universe);
+        put16(buf + 115, 0x7000 | (len - 115));
+        buf[117] = 0x02;
+        buf[118] = 0xA1;
+        put16(buf + 119, 0);
+        put16(buf + 121, 1);
+        put16(buf + 123, n + 1);
+        buf[125] = 0x00;
+        return len;
+    }
+
+    //! write synchronization packet, returns sync_packet_size
+    static size_t write_sync(uint8_t* buf, const uint8_t cid[16], uint8_t seq,
+                             uint16_t sync_address) {
+        write_root(buf, cid, vector_root_extended, sync_packet_size);
+        put16(buf + 38, 0x7000 | (sync_packet_size - 38));
+        put32(buf + 40, vector_extended_sync);
+        buf[44] = seq;
+        put16(buf + 45, sync_address);
+        put16(buf + 47, 0);
+        return sync_packet_size;
+    }
+
+    //! multicast group 239.255.hi.lo of a universe, in host byte order
+    static uint32_t multicast_group(uint16_t universe) {
+        return 0xEFFF0000 | universe;
+    }
+
+private:
+    static const uint32_t vector_root_data = 0x00000004;
+    static const uint32_t vector_root_extended = 0x00000008;
+    static const uint32_t vector_data = 0x00000002;
+    static const uint32_t vector_extended_sync = 0x00000001;
+
+    static const uint8_t* acn_id() {
+        static const uint8_t id[12] = {
+            0x41, 0x53, 0x43, 0x2D, 0x45, 0x31, 0x2E, 0x31, 0x37, 0, 0, 0
+        };
+        return id;
+    }
+
+    static void write_root(uint8_t* buf, const uint8_t cid[16],
+                           uint32_t vector, size_t len) {
+        put16(buf, 0x0010);
+        put16(buf + 2, 0);
+        memcpy(buf + 4, acn_id(), 12);
+        put16(buf + 16, 0x7000 | (len - 16));
+        put32(buf + 18, vector);
+        memcpy(buf + 22, cid, 16);
+    }
+
+    static uint16_t get16(const uint8_t* p) {
+        return (uint16_t(p[0]) << 8) | p[1];
+    }
+    static uint32_t get32(const uint8_t* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+               (uint32_t(p[2]) << 8) | p[3];
+    }
+    static void put16(uint8_t* p, uint16_t v) {
+        p[0] = v >> 8, p[1] = v;
+    }
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = v >> 24, p[1] = v >> 16, p[2] = v >> 8, p[3] = v;
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_E131_HEADER
+
+/******************************************************************************/
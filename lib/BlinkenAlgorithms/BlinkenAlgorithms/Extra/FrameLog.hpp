@@ -0,0 +1,568 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/FrameLog.hpp
+ *
+ * Compact binary log of timestamped strip frames: writer, memory-mapped reader
+ * with seeking, and a player streaming a log to any strip.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_FRAMELOG_HEADER
+#define BLINKENALGORITHMS_EXTRA_FRAMELOG_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Log file layout (little endian):
+ *
+ *   FileHeader
+ *   records: type byte, varint time, varint payload length, payload
+ *   index: IndexEntry for each keyframe
+ *   Trailer
+ *
+ * A keyframe record carries its absolute time in microseconds and is encoded
+ * against a black frame, a delta record carries the time since the previous
+ * record and is encoded against the previous frame. The payload XORs the
+ * frame with its reference and stores runs of pixels: varint count of
+ * unchanged pixels, varint count of changed pixels, then their XORed colors.
+ * An empty payload repeats the previous frame.
+ *
+ * Index and trailer are written by close(). If they are missing, e.g. after a
+ * crash, the reader rebuilds the index by scanning the records.
+ */
+class FrameLog
+{
+public:
+    static const uint32_t magic = 0x524B4C42;       // "BLKR"
+    static const uint32_t index_magic = 0x494B4C42; // "BLKI"
+    static const uint32_t version = 1;
+
+    static const uint8_t keyframe = 0;
+    static const uint8_t delta = 1;
+
+    //! largest frame readers accept, bounding the buffers a header sizes
+    static const uint32_t max_pixels = 1 << 20;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t num_pixels;
+        uint32_t keyframe_interval;
+    };
+
+    struct IndexEntry {
+        uint64_t frame;
+        uint64_t time_us;
+        uint64_t offset;
+    };
+
+    struct Trailer {
+        uint64_t index_offset;
+        uint64_t num_keyframes;
+        uint64_t num_frames;
+        uint32_t magic;
+        uint32_t reserved;
+    };
+
+    static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(uint8_t(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(uint8_t(v));
+    }
+
+    //! decode varint at p, returns false if it runs past end
+    static bool get_varint(const uint8_t*& p, const uint8_t* end,
+                           uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t b = *p++;
+            v |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+};
+
+/******************************************************************************/
+
+class FrameLogWriter
+{
+public:
+    FrameLogWriter() = default;
+
+    //! non-copyable: owns the file
+    FrameLogWriter(const FrameLogWriter&) = delete;
+    FrameLogWriter& operator = (const FrameLogWriter&) = delete;
+
+    ~FrameLogWriter() {
+        close();
+    }
+
+    //! create log file for frames of num_pixels, writing a keyframe every
+    //! keyframe_interval frames for seeking
+    bool open(const std::string& path, size_t num_pixels,
+              size_t keyframe_interval = 256) {
+        close();
+
+        if (num_pixels > FrameLog::max_pixels) {
+            std::cerr << "FrameLogWriter: " << num_pixels
+                      << " pixels exceed the maximum frame size" << std::endl;
+            return false;
+        }
+
+        file_ = fopen(path.c_str(), "wb");
+        if (!file_) {
+            std::cerr << "FrameLogWriter open " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        setvbuf(file_, nullptr, _IOFBF, 256 * 1024);
+
+        num_pixels_ = num_pixels;
+        keyframe_interval_ = std::max<size_t>(keyframe_interval, 1);
+        prev_.assign(num_pixels, 0);
+        index_.clear();
+        num_frames_ = 0;
+        last_time_ = 0;
+
+        FrameLog::FileHeader h;
+        h.magic = FrameLog::magic;
+        h.version = FrameLog::version;
+        h.num_pixels = num_pixels;
+        h.keyframe_interval = keyframe_interval_;
+        if (!write(&h, sizeof(h)))
+            return false;
+        offset_ = sizeof(h);
+
+        start_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool is_open() const { return file_ != nullptr; }
+
+    size_t num_frames() const { return num_frames_; }
+
+    //! append frame with the time since open()
+    bool append(const Color* frame) {
+        return append(
+            frame, std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+    }
+
+    //! Append frame of num_pixels colors at time_us. On write errors the
+    //! file is closed, returns false if the frame was not written.
+    bool append(const Color* frame, uint64_t time_us) {
+        if (!file_)
+            return false;
+
+        const uint32_t* curr = reinterpret_cast<const uint32_t*>(frame);
+        bool key = (num_frames_ % keyframe_interval_ == 0);
+        if (key) {
+            index_.push_back(
+                FrameLog::IndexEntry { num_frames_, time_us, offset_ });
+            std::fill(prev_.begin(), prev_.end(), 0);
+        }
+
+        // encode runs of unchanged and changed pixels
+        payload_.clear();
+        size_t i = 0, n = num_pixels_;
+        while (i < n) {
+            size_t skip = i;
+            while (i < n && curr[i] == prev_[i])
+                ++i;
+            if (i == n)
+                break;
+            size_t lit = i;
+            while (i < n && curr[i] != prev_[i])
+                ++i;
+            FrameLog::put_varint(payload_, lit - skip);
+            FrameLog::put_varint(payload_, i - lit);
+            for (size_t j = lit; j < i; ++j) {
+                uint32_t x = curr[j] ^ prev_[j];
+                const uint8_t* b = reinterpret_cast<const uint8_t*>(&x);
+                payload_.insert(payload_.end(), b, b + 4);
+                prev_[j] = curr[j];
+            }
+        }
+
+        record_.clear();
+        record_.push_back(
+            key ? uint8_t(FrameLog::keyframe) : uint8_t(FrameLog::delta));
+        FrameLog::put_varint(record_, key ? time_us : time_us - last_time_);
+        FrameLog::put_varint(record_, payload_.size());
+
+        if (!write(record_.data(), record_.size()) ||
+            !write(payload_.data(), payload_.size()))
+            return false;
+        offset_ += record_.size() + payload_.size();
+
+        last_time_ = time_us;
+        ++num_frames_;
+        return true;
+    }
+
+    //! write index and trailer and close the file, returns false on errors
+    bool close() {
+        if (!file_)
+            return true;
+
+        if (!write(index_.data(),
+                   index_.size() * sizeof(FrameLog::IndexEntry)))
+            return false;
+
+        FrameLog::Trailer t;
+        t.index_offset = offset_;
+        t.num_keyframes = index_.size();
+        t.num_frames = num_frames_;
+        t.magic = FrameLog::index_magic;
+        t.reserved = 0;
+        if (!write(&t, sizeof(t)))
+            return false;
+
+        int r = fclose(file_);
+        file_ = nullptr;
+        if (r != 0) {
+            std::cerr << "FrameLogWriter close failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    FILE* file_ = nullptr;
+
+    size_t num_pixels_ = 0;
+    size_t keyframe_interval_ = 1;
+
+    //! previous frame, encoding reference
+    std::vector<uint32_t> prev_;
+
+    //! encoding buffers, reused between frames
+    std::vector<uint8_t> record_, payload_;
+
+    std::vector<FrameLog::IndexEntry> index_;
+
+    uint64_t num_frames_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t last_time_ = 0;
+
+    std::chrono::steady_clock::time_point start_;
+
+    //! write to the file, which is closed on errors, e.g. a full disk
+    bool write(const void* data, size_t size) {
+        if (size == 0 || fwrite(data, size, 1, file_) == 1)
+            return true;
+        std::cerr << "FrameLogWriter write failed: "
+                  << strerror(errno) << std::endl;
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+};
+
+/******************************************************************************/
+
+class FrameLogReader
+{
+public:
+    FrameLogReader() = default;
+
+    //! non-copyable: owns the mapping
+    FrameLogReader(const FrameLogReader&) = delete;
+    FrameLogReader& operator = (const FrameLogReader&) = delete;
+
+    ~FrameLogReader() {
+        close();
+    }
+
+    //! map log file and load or rebuild its index
+    bool open(const std::string& path) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "FrameLogReader open " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 ||
+            size_t(st.st_size) < sizeof(FrameLog::FileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        data_ = static_cast<const uint8_t*>(p);
+        madvise(p, size_, MADV_SEQUENTIAL);
+
+        FrameLog::FileHeader h;
+        memcpy(&h, data_, sizeof(h));
+        if (h.magic != FrameLog::magic || h.version != FrameLog::version) {
+            std::cerr << "FrameLogReader: " << path << " is not a frame log"
+                      << std::endl;
+            close();
+            return false;
+        }
+        if (h.num_pixels > FrameLog::max_pixels) {
+            std::cerr << "FrameLogReader: " << path << " has "
+                      << h.num_pixels << " pixels per frame" << std::endl;
+            close();
+            return false;
+        }
+        num_pixels_ = h.num_pixels;
+        frame_.assign(num_pixels_, 0);
+
+        if (!load_index())
+            scan_index(size_);
+
+        pos_ = end_;
+        frame_number_ = num_frames_;
+        seek(0);
+        return true;
+    }
+
+    void close() {
+        if (data_)
+            munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    size_t num_pixels() const { return num_pixels_; }
+    size_t num_frames() const { return num_frames_; }
+
+    //! number of the frame returned by the next call of next()
+    size_t position() const { return frame_number_; }
+
+    //! Position the reader such that next() returns the given frame: decodes
+    //! forward from the closest keyframe.
+    bool seek(size_t frame) {
+        if (index_.empty() || frame >= num_frames_)
+            return false;
+
+        auto it = std::upper_bound(
+            index_.begin(), index_.end(), frame,
+            [](size_t f, const FrameLog::IndexEntry& e) {
+                return f < e.frame;
+            });
+        if (it == index_.begin())
+            return false;
+        --it;
+        pos_ = it->offset;
+        frame_number_ = it->frame;
+        while (frame_number_ < frame) {
+            if (!next())
+                return false;
+        }
+        return true;
+    }
+
+    //! decode the next frame, returns false at the end of the log
+    bool next() {
+        const uint8_t* p = data_ + pos_;
+        const uint8_t* end = data_ + end_;
+        if (p >= end)
+            return false;
+
+        uint8_t type = *p++;
+        uint64_t t, len;
+        if (!FrameLog::get_varint(p, end, t) ||
+            !FrameLog::get_varint(p, end, len) || len > size_t(end - p))
+            return false;
+
+        if (type == FrameLog::keyframe) {
+            std::fill(frame_.begin(), frame_.end(), 0);
+            time_us_ = t;
+        }
+        else {
+            time_us_ += t;
+        }
+
+        const uint8_t* pend = p + len;
+        size_t i = 0;
+        while (p < pend) {
+            uint64_t skip, lit;
+            if (!FrameLog::get_varint(p, pend, skip) ||
+                !FrameLog::get_varint(p, pend, lit) ||
+                skip > num_pixels_ - i || lit > num_pixels_ - i - skip ||
+                lit > size_t(pend - p) / 4)
+                return false;
+            i += skip;
+            for (size_t j = 0; j < lit; ++j, ++i, p += 4) {
+                uint32_t x;
+                memcpy(&x, p, 4);
+                frame_[i] ^= x;
+            }
+        }
+
+        pos_ = pend - data_;
+        ++frame_number_;
+        return true;
+    }
+
+    //! colors of the frame decoded by next()
+    const Color* frame() const {
+        return reinterpret_cast<const Color*>(frame_.data());
+    }
+
+    //! time of the frame decoded by next() in microseconds
+    uint64_t time_us() const { return time_us_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+
+    //! end of the records
+    size_t end_ = 0;
+
+    size_t num_pixels_ = 0;
+    size_t num_frames_ = 0;
+
+    std::vector<FrameLog::IndexEntry> index_;
+
+    //! offset of the next record
+    size_t pos_ = 0;
+    size_t frame_number_ = 0;
+
+    std::vector<uint32_t> frame_;
+    uint64_t time_us_ = 0;
+
+    bool load_index() {
+        if (size_ < sizeof(FrameLog::FileHeader) + sizeof(FrameLog::Trailer))
+            return false;
+
+        FrameLog::Trailer t;
+        memcpy(&t, data_ + size_ - sizeof(t), sizeof(t));
+        if (t.magic != FrameLog::index_magic ||
+            t.index_offset < sizeof(FrameLog::FileHeader) ||
+            t.index_offset > size_ - sizeof(t) ||
+            t.num_keyframes > (size_ - sizeof(t) - t.index_offset) /
+            sizeof(FrameLog::IndexEntry) ||
+            t.num_keyframes * sizeof(FrameLog::IndexEntry) !=
+            size_ - sizeof(t) - t.index_offset)
+            return false;
+
+        index_.resize(t.num_keyframes);
+        memcpy(index_.data(), data_ + t.index_offset,
+               t.num_keyframes * sizeof(FrameLog::IndexEntry));
+
+        // keyframes must lie within the records in increasing order,
+        // otherwise the index is rebuilt by scanning the records
+        for (size_t k = 0; k < index_.size(); ++k) {
+            const FrameLog::IndexEntry& e = index_[k];
+            if (e.offset < sizeof(FrameLog::FileHeader) ||
+                e.offset >= t.index_offset || e.frame >= t.num_frames ||
+                (k != 0 && (e.frame <= index_[k - 1].frame ||
+                            e.offset <= index_[k - 1].offset))) {
+                scan_index(t.index_offset);
+                return true;
+            }
+        }
+
+        end_ = t.index_offset;
+        num_frames_ = t.num_frames;
+        return true;
+    }
+
+    //! rebuild index of the records before limit, ignoring a truncated
+    //! record, e.g. of a log without trailer
+    void scan_index(size_t limit) {
+        index_.clear();
+        num_frames_ = 0;
+
+        size_t pos = sizeof(FrameLog::FileHeader);
+        uint64_t time = 0;
+        while (pos < limit) {
+            const uint8_t* p = data_ + pos;
+            const uint8_t* end = data_ + limit;
+            uint8_t type = *p++;
+            uint64_t t, len;
+            if (!FrameLog::get_varint(p, end, t) ||
+                !FrameLog::get_varint(p, end, len) || len > size_t(end - p))
+                break;
+
+            if (type == FrameLog::keyframe) {
+                time = t;
+                index_.push_back(
+                    FrameLog::IndexEntry { num_frames_, time, pos });
+            }
+            else {
+                time += t;
+            }
+            pos = (p + len) - data_;
+            ++num_frames_;
+        }
+        end_ = pos;
+    }
+};
+
+/******************************************************************************/
+
+/*!
+ * Stream frames [first, last) of a log to a strip. Frames are shown at their
+ * recorded times divided by speed, or as fast as the strip takes them if speed
+ * is zero. Returns the number of frames shown.
+ */
+template <typename Strip>
+size_t ReplayFrameLog(FrameLogReader& log, Strip& strip, double speed = 1.0,
+                      size_t first = 0, size_t last = size_t(-1)) {
+    using clock = std::chrono::steady_clock;
+
+    if (!log.seek(first))
+        return 0;
+
+    size_t n = std::min(log.num_pixels(), strip.size());
+    clock::time_point start = clock::now();
+    uint64_t start_us = 0;
+    size_t count = 0;
+
+    while (log.position() < last && log.next()) {
+        if (count == 0)
+            start_us = log.time_us();
+
+        if (speed > 0) {
+            double offset = (log.time_us() - start_us) / speed;
+            std::this_thread::sleep_until(
+                start + std::chrono::microseconds(uint64_t(offset)));
+        }
+
+        strip.setPixels(0, log.frame(), n);
+        strip.show();
+        ++count;
+    }
+    return count;
+}
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_FRAMELOG_HEADER
+
+/******************************************************************************/
@@ -12,16 +12,12 @@
 #ifndef BLINKENALGORITHMS_EXTRA_MAX7219_HEADER
 #define BLINKENALGORITHMS_EXTRA_MAX7219_HEADER
 
-#include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <vector>
-
-#include <asm/ioctl.h>
-#include <linux/spi/spidev.h>
-#include <sys/ioctl.h>
+#include <string>
 
 #include <BlinkenAlgorithms/Extra/PiGPIO.hpp>
+#include <BlinkenAlgorithms/Extra/PiSPI.hpp>
 
 namespace BlinkenAlgorithms {
 
@@ -47,28 +43,22 @@ public:
     MAX7219(std::string path, size_t cs_pin) {
         memset(display_, 0, sizeof(display_));
 
-        fd_ = open(path.c_str(), O_RDWR);
-        if (fd_ < 0) {
-            std::cerr << "MAX7219 failed" << std::endl;
-            return;
-        }
+        // show all 8 digits
+        config_[MAX7219_REG_SCANLIMIT] = 7;
+        // using an led matrix (not digits)
+        config_[MAX7219_REG_DECODEMODE] = 0;
+        // no display test
+        config_[MAX7219_REG_DISPLAYTEST] = 0;
+        // character intensity: range: 0 to 15
+        config_[MAX7219_REG_INTENSITY] = 15;
+        // not in shutdown mode (ie. start it up)
+        config_[MAX7219_REG_SHUTDOWN] = 1;
 
-        int mode = 3;
-        if (ioctl(fd_, SPI_IOC_WR_MODE, &mode) < 0) {
-            std::cerr << "SPI Mode Change failure: "
-                      << strerror(errno) << std::endl;
-        }
+        reset();
 
-        int spiBPW = 8;
-        if (ioctl(fd_, SPI_IOC_WR_BITS_PER_WORD, &spiBPW) < 0) {
-            std::cerr << "SPI BPW Change failure: "
-                      << strerror(errno) << std::endl;
-        }
-
-        spiSpeed_ = 1200000;
-        if (ioctl(fd_, SPI_IOC_WR_MAX_SPEED_HZ, &spiSpeed_) < 0) {
-            std::cerr << "SPI Speed Change failure: "
-                      << strerror(errno) << std::endl;
+        if (!spi_.open(path, /* speed_hz */ 1200000)) {
+            std::cerr << "MAX7219 failed" << std::endl;
+            return;
         }
 
         cs_gpio_.set_pin(cs_pin, /* output */ true);
@@ -98,25 +88,50 @@ public:
         memset(display_, 0, sizeof(display_));
     }
 
+    //! set character intensity: range 0 to 15, sent with the next show()
+    void set_intensity(uint8_t intensity) {
+        config_[MAX7219_REG_INTENSITY] = intensity > 15 ? 15 : intensity;
+    }
+
+    //! forget the transmitted state, e.g. after the matrix was power cycled,
+    //! such that the next show() sends configuration and all rows.
+    void reset() {
+        memset(sent_config_, 0xFF, sizeof(sent_config_));
+        sent_valid_ = false;
+    }
+
+    //! Transmit changed configuration registers and changed rows. Each row
+    //! of all daisy-chained devices is one transfer.
     void show() {
-        // show all 8 digits
-        Broadcast(MAX7219_REG_SCANLIMIT, 7);
-        // using an led matrix (not digits)
-        Broadcast(MAX7219_REG_DECODEMODE, 0);
-        // no display test
-        Broadcast(MAX7219_REG_DISPLAYTEST, 0);
-        // character intensity: range: 0 to 15
-        Broadcast(MAX7219_REG_INTENSITY, 15);
-        // not in shutdown mode (ie. start it up)
-        Broadcast(MAX7219_REG_SHUTDOWN, 1);
+        static const uint8_t s_config_regs[] = {
+            MAX7219_REG_SCANLIMIT, MAX7219_REG_DECODEMODE,
+            MAX7219_REG_DISPLAYTEST, MAX7219_REG_INTENSITY,
+            MAX7219_REG_SHUTDOWN
+        };
+
+        for (uint8_t reg : s_config_regs) {
+            if (sent_config_[reg] != config_[reg]) {
+                Broadcast(reg, config_[reg]);
+                sent_config_[reg] = config_[reg];
+            }
+        }
 
         for (size_t j = 0; j < 8; ++j) {
-            cs_gpio_.write(0);
+            bool changed = !sent_valid_;
+            for (size_t i = 0; i < num_devices_ && !changed; ++i)
+                changed = (display_[8 * i + j] != sent_[8 * i + j]);
+            if (!changed)
+                continue;
+
+            uint8_t frame[2 * num_devices_];
             for (size_t i = 0; i < num_devices_; ++i) {
-                SPIwrite_pair(MAX7219_REG_DIGIT0 + j, display_[8 * i + j]);
+                frame[2 * i] = MAX7219_REG_DIGIT0 + j;
+                frame[2 * i + 1] = display_[8 * i + j];
+                sent_[8 * i + j] = display_[8 * i + j];
             }
-            cs_gpio_.write(1);
+            SPIwrite(frame, sizeof(frame));
         }
+        sent_valid_ = true;
     }
 
 protected:
@@ -124,45 +139,38 @@ protected:
 
     uint8_t display_[num_devices_ * 8];
 
-    void Broadcast(uint8_t reg, uint8_t data) {
-        cs_gpio_.write(0);
-        for (size_t i = 0; i < num_devices_; ++i) {
-            SPIwrite_pair(reg, data);
-        }
-        cs_gpio_.write(1);
-    }
+    //! display rows last transmitted
+    uint8_t sent_[num_devices_ * 8];
 
-    void SPIwrite_pair(uint8_t reg, uint8_t data) {
-        uint8_t a[2] = { reg, data };
-        SPIwrite(a, sizeof(a));
-    }
-
-    int SPIwrite(unsigned char* data, int len) {
+    //! whether sent_ reflects the devices
+    bool sent_valid_ = false;
 
-        struct spi_ioc_transfer spi;
-        memset(&spi, 0, sizeof(spi));
+    //! wanted configuration register values, indexed by register
+    uint8_t config_[16] = { 0 };
 
-        spi.tx_buf = (unsigned long)data;
-        spi.rx_buf = 0x0;
-        spi.len = len;
-        spi.delay_usecs = 0;
-        spi.speed_hz = spiSpeed_;
-        spi.bits_per_word = 8;
+    //! configuration register values last transmitted, 0xFFFF = unknown
+    uint16_t sent_config_[16];
 
-        int x = ioctl(fd_, SPI_IOC_MESSAGE(1), &spi);
+    void Broadcast(uint8_t reg, uint8_t data) {
+        uint8_t frame[2 * num_devices_];
+        for (size_t i = 0; i < num_devices_; ++i) {
+            frame[2 * i] = reg;
+            frame[2 * i + 1] = data;
+        }
+        SPIwrite(frame, sizeof(frame));
+    }
 
+    //! write one frame to all devices, latched by the CS pin
+    int SPIwrite(const uint8_t* data, size_t len) {
+        cs_gpio_.write(0);
+        int x = spi_.write(data, len);
+        cs_gpio_.write(1);
         return x;
     }
 
 private:
-    //! strip length
-    size_t strip_size_;
-
-    //! device file descriptor
-    int fd_;
-
-    //! SPI speed
-    size_t spiSpeed_;
+    //! spidev device
+    PiSPI spi_;
 
     //! GPIO CS Pin for SPI multiplex
     GPIOPin cs_gpio_;
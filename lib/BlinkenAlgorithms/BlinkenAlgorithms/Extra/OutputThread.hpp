@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/OutputThread.hpp
+ *
+ * Dedicated thread which runs a strip's transmit function on request, such
+ * that rendering the next frame overlaps the transfer of the current one.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_OUTPUTTHREAD_HEADER
+#define BLINKENALGORITHMS_EXTRA_OUTPUTTHREAD_HEADER
+
+#include <BlinkenAlgorithms/Extra/RealTime.hpp>
+#include <BlinkenAlgorithms/Trace.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace BlinkenAlgorithms {
+
+class OutputThread
+{
+public:
+    //! start thread which runs job each time submit() is called, it follows
+    //! the RealTime profile of the Output role
+    explicit OutputThread(std::function<void()> job)
+        : job_(std::move(job)),
+          thread_([this]() { run(); }) {
+        RealTime::attach(RealTime::Output, thread_.native_handle());
+    }
+
+    //! non-copyable: owns the thread
+    OutputThread(const OutputThread&) = delete;
+    OutputThread& operator = (const OutputThread&) = delete;
+
+    ~OutputThread() {
+        RealTime::detach(thread_.native_handle());
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    //! whether a job is queued or running
+    bool busy() const {
+        return busy_.load(std::memory_order_acquire);
+    }
+
+    //! block until the previous job is finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !busy_; });
+    }
+
+    //! wait until idle, then start the job in the thread
+    void submit() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !busy_; });
+        busy_.store(true, std::memory_order_release);
+        lock.unlock();
+        cv_.notify_all();
+    }
+
+protected:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return busy_ || stop_; });
+            if (!busy_ && stop_)
+                return;
+
+            lock.unlock();
+            {
+                BLINKEN_TRACE_SPAN("transmit");
+                job_();
+            }
+            lock.lock();
+
+            busy_.store(false, std::memory_order_release);
+            cv_.notify_all();
+        }
+    }
+
+private:
+    //! transmit function
+    std::function<void()> job_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    //! set by submit(), cleared by the thread when the job is done
+    std::atomic<bool> busy_ { false };
+
+    //! flag to terminate the thread
+    bool stop_ = false;
+
+    //! the thread itself, must be constructed last
+    std::thread thread_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_OUTPUTTHREAD_HEADER
+
+/******************************************************************************/
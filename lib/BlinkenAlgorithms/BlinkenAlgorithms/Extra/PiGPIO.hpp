@@ -9,49 +9,65 @@
 #ifndef BLINKENALGORITHMS_EXTRA_PIGPIO_HEADER
 #define BLINKENALGORITHMS_EXTRA_PIGPIO_HEADER
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
 #include <fcntl.h>
+#include <linux/gpio.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 namespace BlinkenAlgorithms {
 
-class GPIOPin
+/******************************************************************************/
+// GPIO Backends
+
+class GPIOBackend
 {
 public:
-    //! construct null pin
-    GPIOPin() = default;
+    virtual ~GPIOBackend() = default;
 
-    //! construct and initialize
-    GPIOPin(int pin, bool output) {
-        set_pin(pin, output);
-    }
+    //! short name for diagnostics
+    virtual const char* name() const = 0;
+
+    //! configure pin direction, false if the backend is not available
+    virtual bool open(int pin, bool output) = 0;
 
-    ~GPIOPin() {
+    //! read value of GPIO pin
+    virtual int read() = 0;
+
+    //! set value of GPIO pin
+    virtual void write(bool value) = 0;
+};
+
+/*!
+ * GPIO via /sys/class/gpio: each access is a syscall on the value file and a
+ * string parse in the kernel. Slowest, but available on all kernels.
+ */
+class GPIOSysfs : public GPIOBackend
+{
+public:
+    ~GPIOSysfs() {
+        if (fd_value_ >= 0)
+            close(fd_value_);
         if (pin_ >= 0)
             unexport_pin(pin_);
     }
 
-    //! initialize
-    bool set_pin(int pin, bool output) {
-        if (pin < 0) {
-            pin_ = pin;
-            return true;
-        }
-        else if (export_pin(pin) && set_direction(pin, output)) {
-            pin_ = pin;
-            return true;
-        }
-        return false;
-    }
-
-    //! return initialized pin
-    int pin() const { return pin_; }
+    const char* name() const final { return "sysfs"; }
 
-    //! read value of GPIO pin
-    int read() {
-        if (pin_ < 0)
-            return -1;
+    bool open(int pin, bool output) final {
+        if (!export_pin(pin))
+            return false;
+        pin_ = pin;
+        return set_direction(pin, output);
+    }
 
+    int read() final {
         char value_str[3];
 
         if (::read(fd_value_, value_str, 3) < 0) {
@@ -62,11 +78,7 @@ public:
         return atoi(value_str);
     }
 
-    //! set value of GPIO pin
-    void write(bool value) {
-        if (pin_ < 0)
-            return;
-
+    void write(bool value) final {
         static const char* s_values_str[] = { "0\n", "1\n" };
 
         if (::write(fd_value_, s_values_str[value], 2) != 2) {
@@ -79,7 +91,7 @@ protected:
     static bool export_pin(int pin) {
         char buffer[16];
 
-        int fd = open("/sys/class/gpio/export", O_WRONLY);
+        int fd = ::open("/sys/class/gpio/export", O_WRONLY);
         if (fd < 0) {
             fprintf(stderr, "Failed to open export for writing!\n");
             return false;
@@ -95,7 +107,7 @@ protected:
     static bool unexport_pin(int pin) {
         char buffer[16];
 
-        int fd = open("/sys/class/gpio/unexport", O_WRONLY);
+        int fd = ::open("/sys/class/gpio/unexport", O_WRONLY);
         if (fd < 0) {
             fprintf(stderr, "Failed to open unexport for writing!\n");
             return false;
@@ -117,7 +129,7 @@ protected:
         snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/direction", pin);
 
         for (size_t r = 0; ; ++r) {
-            int fd = open(path, O_WRONLY);
+            int fd = ::open(path, O_WRONLY);
             if (fd < 0) {
                 if (r >= 50) {
                     fprintf(stderr, "Failed to open gpio direction for writing!\n");
@@ -144,14 +156,14 @@ protected:
         snprintf(path, sizeof(path), "/sys/class/gpio/gpio%d/value", pin);
 
         if (!output) {
-            fd_value_ = open(path, O_RDONLY);
+            fd_value_ = ::open(path, O_RDONLY);
             if (fd_value_ < 0) {
                 fprintf(stderr, "Failed to open gpio value for reading!\n");
                 return false;
             }
         }
         else {
-            fd_value_ = open(path, O_WRONLY);
+            fd_value_ = ::open(path, O_WRONLY);
             if (fd_value_ < 0) {
                 fprintf(stderr, "Failed to open gpio value for writing!\n");
                 return false;
@@ -161,12 +173,254 @@ protected:
         return true;
     }
 
+private:
+    //! exported pin number
+    int pin_ = -1;
+
+    //! fd for value
+    int fd_value_ = -1;
+};
+
+/*!
+ * GPIO via the Linux GPIO character device: one ioctl per access on a line
+ * handle, without the string handling of sysfs.
+ */
+class GPIOChardev : public GPIOBackend
+{
+public:
+    explicit GPIOChardev(const char* chip = "/dev/gpiochip0")
+        : chip_(chip) { }
+
+    ~GPIOChardev() {
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    const char* name() const final { return "chardev"; }
+
+    bool open(int pin, bool output) final {
+        int chip_fd = ::open(chip_, O_RDONLY);
+        if (chip_fd < 0)
+            return false;
+
+        struct gpiohandle_request req;
+        memset(&req, 0, sizeof(req));
+        req.lineoffsets[0] = pin;
+        req.flags = output ? GPIOHANDLE_REQUEST_OUTPUT
+                    : GPIOHANDLE_REQUEST_INPUT;
+        req.lines = 1;
+        strncpy(req.consumer_label, "BlinkenAlgorithms",
+                sizeof(req.consumer_label) - 1);
+
+        int r = ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+        close(chip_fd);
+        if (r < 0)
+            return false;
+
+        fd_ = req.fd;
+        return true;
+    }
+
+    int read() final {
+        struct gpiohandle_data data;
+        if (ioctl(fd_, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+            fprintf(stderr, "Failed to read value!\n");
+            return -1;
+        }
+        return data.values[0];
+    }
+
+    void write(bool value) final {
+        struct gpiohandle_data data;
+        memset(&data, 0, sizeof(data));
+        data.values[0] = value;
+        if (ioctl(fd_, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0)
+            fprintf(stderr, "Failed to write value!\n");
+    }
+
+private:
+    //! gpiochip device path
+    const char* chip_;
+
+    //! line handle fd
+    int fd_ = -1;
+};
+
+/*!
+ * GPIO via the BCM283x/BCM2711 registers mapped from /dev/gpiomem: set and
+ * clear are single stores into the write-only GPSET/GPCLR registers, without
+ * any syscall. Not available on the Pi 5, whose GPIOs are behind the RP1.
+ */
+class GPIOMem : public GPIOBackend
+{
+public:
+    const char* name() const final { return "gpiomem"; }
+
+    bool open(int pin, bool output) final {
+        regs_ = registers();
+        if (!regs_ || pin < 0 || pin > 53)
+            return false;
+
+        // three function select bits per pin: 000 = input, 001 = output
+        volatile uint32_t* fsel = regs_ + gpfsel_ + pin / 10;
+        unsigned shift = (pin % 10) * 3;
+        *fsel = (*fsel & ~(7u << shift)) | ((output ? 1u : 0u) << shift);
+
+        bank_ = pin / 32;
+        mask_ = uint32_t(1) << (pin % 32);
+        return true;
+    }
+
+    int read() final {
+        return (regs_[gplev_ + bank_] & mask_) != 0;
+    }
+
+    void write(bool value) final {
+        if (value)
+            regs_[gpset_ + bank_] = mask_;
+        else
+            regs_[gpclr_ + bank_] = mask_;
+    }
+
+    //! shared register mapping, nullptr if /dev/gpiomem is not available
+    static volatile uint32_t* registers() {
+        static volatile uint32_t* s_regs = map_registers();
+        return s_regs;
+    }
+
+private:
+    //! register word offsets: GPFSEL0 0x00, GPSET0 0x1C, GPCLR0 0x28,
+    //! GPLEV0 0x34
+    static const size_t gpfsel_ = 0x00 / 4;
+    static const size_t gpset_ = 0x1C / 4;
+    static const size_t gpclr_ = 0x28 / 4;
+    static const size_t gplev_ = 0x34 / 4;
+
+    //! size of the GPIO register block
+    static const size_t block_size_ = 4096;
+
+    volatile uint32_t* regs_ = nullptr;
+
+    //! register bank (0 for pins 0-31, 1 for 32-53) and bit mask of the pin
+    size_t bank_ = 0;
+    uint32_t mask_ = 0;
+
+    static volatile uint32_t* map_registers() {
+        int fd = ::open("/dev/gpiomem", O_RDWR | O_SYNC);
+        if (fd < 0)
+            return nullptr;
+
+        void* p = mmap(nullptr, block_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (p == MAP_FAILED)
+            return nullptr;
+        return static_cast<volatile uint32_t*>(p);
+    }
+};
+
+/*!
+ * In-memory GPIO which only records the written values, for running the
+ * drivers without hardware.
+ */
+class GPIOStub : public GPIOBackend
+{
+public:
+    const char* name() const final { return "stub"; }
+
+    bool open(int pin, bool /* output */) final {
+        pin_ = pin;
+        return true;
+    }
+
+    int read() final { return value_; }
+
+    void write(bool value) final {
+        if (value != value_)
+            ++toggles_;
+        value_ = value;
+        ++writes_;
+    }
+
+    int pin() const { return pin_; }
+    size_t writes() const { return writes_; }
+    size_t toggles() const { return toggles_; }
+
+private:
+    int pin_ = -1;
+    bool value_ = false;
+    size_t writes_ = 0, toggles_ = 0;
+};
+
+/******************************************************************************/
+// GPIOPin
+
+class GPIOPin
+{
+public:
+    //! construct null pin
+    GPIOPin() = default;
+
+    //! construct and initialize
+    GPIOPin(int pin, bool output) {
+        set_pin(pin, output);
+    }
+
+    //! Initialize pin with the fastest available backend: mapped registers,
+    //! then the character device, then sysfs.
+    bool set_pin(int pin, bool output) {
+        backend_.reset();
+        pin_ = -1;
+        if (pin < 0)
+            return true;
+
+        if (set_pin(pin, output, std::unique_ptr<GPIOBackend>(new GPIOMem)))
+            return true;
+        if (set_pin(pin, output,
+                    std::unique_ptr<GPIOBackend>(new GPIOChardev)))
+            return true;
+        return set_pin(pin, output,
+                       std::unique_ptr<GPIOBackend>(new GPIOSysfs));
+    }
+
+    //! initialize pin with a specific backend
+    bool set_pin(int pin, bool output, std::unique_ptr<GPIOBackend> backend) {
+        if (!backend->open(pin, output))
+            return false;
+        backend_ = std::move(backend);
+        pin_ = pin;
+        return true;
+    }
+
+    //! return initialized pin
+    int pin() const { return pin_; }
+
+    //! name of backend in use, or "none"
+    const char* backend_name() const {
+        return backend_ ? backend_->name() : "none";
+    }
+
+    //! read value of GPIO pin
+    int read() {
+        if (!backend_)
+            return -1;
+        return backend_->read();
+    }
+
+    //! set value of GPIO pin
+    void write(bool value) {
+        if (!backend_)
+            return;
+        backend_->write(value);
+    }
+
 protected:
     //! pin number
     int pin_ = -1;
 
-    //! fd for value
-    int fd_value_;
+    //! access method
+    std::unique_ptr<GPIOBackend> backend_;
 };
 
 } // namespace BlinkenAlgorithms
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/PiSPI.hpp
+ *
+ * Thin wrapper around a Linux spidev device which submits scatter/gather
+ * frames with as few SPI_IOC_MESSAGE ioctls as the driver permits. A regular
+ * file or FIFO in place of the device receives the transferred bytes, which
+ * lets the drivers run on hosts for tests and benchmarks.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_PISPI_HEADER
+#define BLINKENALGORITHMS_EXTRA_PISPI_HEADER
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asm/ioctl.h>
+#include <fcntl.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+class PiSPI
+{
+public:
+    PiSPI() = default;
+
+    //! non-copyable: owns the file descriptor
+    PiSPI(const PiSPI&) = delete;
+    PiSPI& operator = (const PiSPI&) = delete;
+
+    ~PiSPI() {
+        close();
+    }
+
+    //! open spidev device and configure mode, word size and speed
+    bool open(const std::string& path, uint32_t speed_hz, uint8_t mode = 3) {
+        close();
+
+        fd_ = ::open(path.c_str(), O_RDWR);
+        if (fd_ < 0) {
+            std::cerr << "PiSPI open " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+
+        speed_hz_ = speed_hz;
+        bufsiz_ = spidev_bufsiz();
+
+        // mock device: append each message's transfers to the file
+        struct stat st;
+        mock_ = fstat(fd_, &st) == 0 && !S_ISCHR(st.st_mode);
+        if (mock_)
+            return true;
+
+        if (ioctl(fd_, SPI_IOC_WR_MODE, &mode) < 0) {
+            std::cerr << "SPI Mode Change failure: "
+                      << strerror(errno) << std::endl;
+        }
+
+        uint8_t spiBPW = 8;
+        if (ioctl(fd_, SPI_IOC_WR_BITS_PER_WORD, &spiBPW) < 0) {
+            std::cerr << "SPI BPW Change failure: "
+                      << strerror(errno) << std::endl;
+        }
+
+        if (ioctl(fd_, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz_) < 0) {
+            std::cerr << "SPI Speed Change failure: "
+                      << strerror(errno) << std::endl;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+
+    //! whether a file stands in for the spidev device
+    bool is_mock() const { return mock_; }
+
+    //! number of SPI messages (ioctls) submitted so far
+    size_t messages() const { return messages_; }
+
+    //! spidev's maximum bytes per message
+    size_t bufsiz() const { return bufsiz_; }
+
+    //! whether mock devices take as long as the bus would for each message
+    static bool& mock_wire_time() {
+        static bool s_wire_time = false;
+        return s_wire_time;
+    }
+
+    uint32_t speed_hz() const { return speed_hz_; }
+
+    //! Largest single transfer, longer segments are split at this size.
+    //! spidev accounts each transfer with kmalloc alignment padding.
+    size_t max_transfer() const {
+        return bufsiz_ & ~(kmalloc_minalign_ - 1);
+    }
+
+    //! write a single contiguous buffer
+    int write(const void* data, size_t len) {
+        struct iovec iov;
+        iov.iov_base = const_cast<void*>(data);
+        iov.iov_len = len;
+        return write(&iov, 1);
+    }
+
+    //! Write a scatter/gather frame. Segments are split into transfers of at
+    //! most bufsiz bytes, and consecutive transfers are packed into one
+    //! SPI_IOC_MESSAGE(n) as long as spidev accepts the total size. Returns
+    //! the number of bytes written or -1 on error.
+    int write(const struct iovec* iov, size_t iovcnt) {
+        if (fd_ < 0)
+            return -1;
+
+        const size_t max_chunk = max_transfer();
+
+        xfers_.clear();
+        size_t msg_total = 0;
+        int written = 0;
+
+        for (size_t v = 0; v < iovcnt; ++v) {
+            const uint8_t* data = static_cast<const uint8_t*>(iov[v].iov_base);
+            size_t len = iov[v].iov_len;
+
+            for (size_t off = 0; off < len; off += max_chunk) {
+                size_t chunk = std::min(len - off, max_chunk);
+                size_t padded =
+                    (chunk + kmalloc_minalign_ - 1) & ~(kmalloc_minalign_ - 1);
+
+                if (!xfers_.empty() &&
+                    (msg_total + padded > bufsiz_ ||
+                     xfers_.size() >= max_transfers_)) {
+                    if (submit() < 0)
+                        return -1;
+                    msg_total = 0;
+                }
+
+                struct spi_ioc_transfer spi;
+                memset(&spi, 0, sizeof(spi));
+
+                spi.tx_buf = reinterpret_cast<uintptr_t>(data + off);
+                spi.rx_buf = 0;
+                spi.len = chunk;
+                spi.delay_usecs = 0;
+                spi.speed_hz = speed_hz_;
+                spi.bits_per_word = 8;
+
+                xfers_.push_back(spi);
+                msg_total += padded;
+                written += chunk;
+            }
+        }
+
+        if (!xfers_.empty() && submit() < 0)
+            return -1;
+
+        return written;
+    }
+
+    //! read the spidev module's per-message buffer limit
+    static size_t spidev_bufsiz() {
+        size_t bufsiz = 4096;
+
+        int fd = ::open("/sys/module/spidev/parameters/bufsiz", O_RDONLY);
+        if (fd < 0)
+            return bufsiz;
+
+        char buffer[32];
+        ssize_t rb = ::read(fd, buffer, sizeof(buffer) - 1);
+        if (rb > 0) {
+            buffer[rb] = 0;
+            size_t v = strtoul(buffer, nullptr, 10);
+            if (v >= kmalloc_minalign_)
+                bufsiz = v;
+        }
+        ::close(fd);
+
+        return bufsiz;
+    }
+
+protected:
+    //! issue one SPI_IOC_MESSAGE with all queued transfers
+    int submit() {
+        ++messages_;
+        if (mock_) {
+            iov_.clear();
+            for (const struct spi_ioc_transfer& t : xfers_) {
+                struct iovec v;
+                v.iov_base = reinterpret_cast<void*>(uintptr_t(t.tx_buf));
+                v.iov_len = t.len;
+                iov_.push_back(v);
+            }
+            xfers_.clear();
+            ssize_t wb = ::writev(fd_, iov_.data(), iov_.size());
+            if (wb > 0 && mock_wire_time()) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    uint64_t(wb) * 8 * 1000000000 / speed_hz_));
+            }
+            return wb < 0 ? -1 : 0;
+        }
+        int x = ioctl(
+            fd_, _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0,
+                      sizeof(struct spi_ioc_transfer) * xfers_.size()),
+            xfers_.data());
+        xfers_.clear();
+        return x;
+    }
+
+private:
+    //! kmalloc alignment which spidev adds to each transfer (conservative)
+    static const size_t kmalloc_minalign_ = 128;
+
+    //! limited by the 14-bit size field of the ioctl number
+    static const size_t max_transfers_ = 256;
+
+    //! device file descriptor
+    int fd_ = -1;
+
+    //! SPI speed
+    uint32_t speed_hz_ = 0;
+
+    //! spidev's maximum bytes per message
+    size_t bufsiz_ = 4096;
+
+    //! transfer descriptors of the message being built
+    std::vector<struct spi_ioc_transfer> xfers_;
+
+    //! fd is a file standing in for the device
+    bool mock_ = false;
+
+    //! number of messages submitted
+    size_t messages_ = 0;
+
+    //! transfers of the message in mock mode
+    std::vector<struct iovec> iov_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_PISPI_HEADER
+
+/******************************************************************************/
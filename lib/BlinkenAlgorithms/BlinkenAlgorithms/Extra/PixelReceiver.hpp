@@ -0,0 +1,356 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/PixelReceiver.hpp
+ *
+ * Receive pixel data from lighting software via DDP or E1.31 (sACN) and show
+ * it on a strip, turning the Pi into a pixel controller.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_PIXELRECEIVER_HEADER
+#define BLINKENALGORITHMS_EXTRA_PIXELRECEIVER_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Extra/DDP.hpp>
+#include <BlinkenAlgorithms/Extra/E131.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Receiver writing DDP or E1.31 payloads into a framebuffer strip, e.g.
+ * FramebufferStrip or PipelineStrip, and calling its show() when a frame is
+ * complete: on the DDP push flag, on an E1.31 sync packet, or without sync
+ * address on the last universe covering the strip.
+ *
+ * Packets are fetched in batches with one recvmmsg() call each, and payload
+ * bytes are stored straight into the strip's color array.
+ */
+template <typename Strip>
+class PixelReceiver
+{
+public:
+    enum Protocol { ddp, e131 };
+
+    struct Stats {
+        size_t packets = 0;
+        size_t frames = 0;
+        //! packets missing according to sequence numbers
+        size_t lost = 0;
+        //! E1.31 packets discarded as late
+        size_t out_of_order = 0;
+        size_t malformed = 0;
+        //! time from kernel receipt of the first packet of a frame until
+        //! its show() returned
+        uint64_t latency_sum_us = 0;
+        uint64_t latency_max_us = 0;
+
+        double latency_avg_us() const {
+            return frames ? double(latency_sum_us) / frames : 0.0;
+        }
+    };
+
+    explicit PixelReceiver(Strip& strip)
+        : strip_(strip) { }
+
+    //! non-copyable: owns the socket
+    PixelReceiver(const PixelReceiver&) = delete;
+    PixelReceiver& operator = (const PixelReceiver&) = delete;
+
+    ~PixelReceiver() {
+        close();
+    }
+
+    //! Open UDP socket for protocol, port 0 selects the protocol's default.
+    //! E1.31 maps universes starting at first_universe with
+    //! channels_per_universe channels each onto the strip and joins their
+    //! multicast groups.
+    bool open(Protocol protocol, uint16_t port = 0,
+              uint16_t first_universe = 1,
+              size_t channels_per_universe = 510, bool rgbw = false) {
+        close();
+
+        protocol_ = protocol;
+        first_universe_ = first_universe;
+        channels_per_universe_ =
+            std::min(channels_per_universe, size_t(E131::max_channels));
+        e131_bytes_per_pixel_ = rgbw ? 4 : 3;
+        if (port == 0)
+            port = protocol == ddp ? uint16_t(DDP::port) : uint16_t(E131::port);
+
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) {
+            std::cerr << "PixelReceiver socket failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one));
+        int rcvbuf = 1 << 20;
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr),
+                 sizeof(addr)) < 0) {
+            std::cerr << "PixelReceiver bind port " << port << " failed: "
+                      << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+
+        if (protocol == e131) {
+            for (uint16_t u = first_universe_; u <= last_universe(); ++u) {
+                struct ip_mreq mreq;
+                mreq.imr_multiaddr.s_addr = htonl(E131::multicast_group(u));
+                mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+                // fails without multicast route, unicast still works
+                setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                           &mreq, sizeof(mreq));
+            }
+            universe_seq_.assign(last_universe() - first_universe_ + 1, -1);
+        }
+
+        // set up batch receive buffers
+        buffers_.resize(batch_size_ * buffer_size_);
+        msgs_.resize(batch_size_);
+        iovs_.resize(batch_size_);
+        controls_.resize(batch_size_ * control_size_);
+        for (size_t i = 0; i < batch_size_; ++i) {
+            iovs_[i].iov_base = &buffers_[i * buffer_size_];
+            iovs_[i].iov_len = buffer_size_;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+
+    //! Wait up to timeout_ms for packets, then process all pending ones in
+    //! batches. Returns the number of frames shown.
+    size_t poll(int timeout_ms) {
+        if (fd_ < 0)
+            return 0;
+
+        struct pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLIN;
+        if (::poll(&pfd, 1, timeout_ms) <= 0)
+            return 0;
+
+        size_t frames = stats_.frames;
+        while (true) {
+            for (size_t i = 0; i < batch_size_; ++i) {
+                struct msghdr& h = msgs_[i].msg_hdr;
+                memset(&h, 0, sizeof(h));
+                h.msg_iov = &iovs_[i];
+                h.msg_iovlen = 1;
+                h.msg_control = &controls_[i * control_size_];
+                h.msg_controllen = control_size_;
+            }
+
+            int n = recvmmsg(fd_, msgs_.data(), batch_size_,
+                             MSG_DONTWAIT, nullptr);
+            if (n <= 0)
+                break;
+
+            for (int i = 0; i < n; ++i) {
+                ++stats_.packets;
+                const uint8_t* buf = &buffers_[i * buffer_size_];
+                size_t len = msgs_[i].msg_len;
+                note_timestamp(msgs_[i].msg_hdr);
+                if (protocol_ == ddp)
+                    process_ddp(buf, len);
+                else
+                    process_e131(buf, len);
+            }
+
+            if (size_t(n) < batch_size_)
+                break;
+        }
+        return stats_.frames - frames;
+    }
+
+    const Stats& stats() const { return stats_; }
+
+    void reset_stats() { stats_ = Stats(); }
+
+private:
+    //! packets per recvmmsg() call
+    static const size_t batch_size_ = 32;
+    //! large enough for DDP and E1.31 packets within an ethernet MTU
+    static const size_t buffer_size_ = 1536;
+    static const size_t control_size_ = 64;
+
+    Strip& strip_;
+
+    int fd_ = -1;
+
+    Protocol protocol_ = ddp;
+
+    //! E1.31 universe mapping
+    uint16_t first_universe_ = 1;
+    size_t channels_per_universe_ = 510;
+    size_t e131_bytes_per_pixel_ = 3;
+
+    //! last sequence number per universe, -1 if none yet
+    std::vector<int> universe_seq_;
+    //! sync address of the last E1.31 data packet
+    uint16_t sync_address_ = 0;
+    //! last DDP sequence number, 0 if none yet
+    uint8_t ddp_seq_ = 0;
+
+    //! receive time of the first packet of the current frame, 0 if none
+    uint64_t frame_start_ns_ = 0;
+
+    std::vector<uint8_t> buffers_;
+    std::vector<struct mmsghdr> msgs_;
+    std::vector<struct iovec> iovs_;
+    std::vector<uint8_t> controls_;
+
+    Stats stats_;
+
+    uint16_t last_universe() const {
+        size_t bytes = strip_.size() * e131_bytes_per_pixel_;
+        size_t n = (bytes + channels_per_universe_ - 1) /
+                   channels_per_universe_;
+        return first_universe_ + std::max<size_t>(n, 1) - 1;
+    }
+
+    static uint64_t realtime_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    //! remember kernel receive time of the first packet of a frame
+    void note_timestamp(struct msghdr& h) {
+        if (frame_start_ns_)
+            return;
+        frame_start_ns_ = realtime_ns();
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&h); c;
+             c = CMSG_NXTHDR(&h, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                frame_start_ns_ = uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+            }
+        }
+    }
+
+    //! show the frame and account its latency
+    void latch() {
+        strip_.show();
+        ++stats_.frames;
+        uint64_t us = (realtime_ns() - frame_start_ns_) / 1000;
+        stats_.latency_sum_us += us;
+        stats_.latency_max_us = std::max(stats_.latency_max_us, us);
+        frame_start_ns_ = 0;
+    }
+
+    //! store bytes at byte offset of a frame of bpp bytes per pixel
+    void store(size_t offset, const uint8_t* data, size_t n, size_t bpp) {
+        size_t end = std::min(offset + n, strip_.size() * bpp);
+        Color* colors = strip_.data();
+        for (size_t i = offset; i < end; ++i, ++data) {
+            Color& c = colors[i / bpp];
+            switch (i % bpp) {
+            case 0: c.r = *data; break;
+            case 1: c.g = *data; break;
+            case 2: c.b = *data; break;
+            case 3: c.w = *data; break;
+            }
+        }
+    }
+
+    void process_ddp(const uint8_t* buf, size_t len) {
+        DDP::Packet p;
+        if (!DDP::parse(buf, len, p) ||
+            (p.id != DDP::id_display && p.id != 0)) {
+            ++stats_.malformed;
+            return;
+        }
+
+        if (p.seq) {
+            if (ddp_seq_)
+                stats_.lost += (p.seq + 15 - DDP::next_seq(ddp_seq_)) % 15;
+            ddp_seq_ = p.seq;
+        }
+
+        store(p.offset, p.data, p.length, p.type == DDP::type_rgbw8 ? 4 : 3);
+
+        if (p.flags & DDP::flag_push)
+            latch();
+    }
+
+    void process_e131(const uint8_t* buf, size_t len) {
+        E131::Packet p;
+        if (!E131::parse(buf, len, p)) {
+            ++stats_.malformed;
+            return;
+        }
+
+        if (p.sync) {
+            if (p.sync_address != 0 && p.sync_address == sync_address_)
+                latch();
+            return;
+        }
+
+        if (p.universe < first_universe_ || p.universe > last_universe() ||
+            (p.options & (E131::option_preview | E131::option_terminated)))
+            return;
+
+        // discard late packets, count gaps as lost (E1.31 6.7.2)
+        int& last = universe_seq_[p.universe - first_universe_];
+        if (last >= 0) {
+            int8_t diff = int8_t(p.seq - uint8_t(last));
+            if (diff <= 0 && diff > -20) {
+                ++stats_.out_of_order;
+                return;
+            }
+            if (diff > 1)
+                stats_.lost += diff - 1;
+        }
+        last = p.seq;
+        sync_address_ = p.sync_address;
+
+        size_t n = std::min<size_t>(p.length, channels_per_universe_);
+        store((p.universe - first_universe_) * channels_per_universe_,
+              p.data, n, e131_bytes_per_pixel_);
+
+        if (p.sync_address == 0 && p.universe == last_universe())
+            latch();
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_PIXELRECEIVER_HEADER
+
+/******************************************************************************/
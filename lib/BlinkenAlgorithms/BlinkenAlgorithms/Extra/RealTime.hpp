@@ -0,0 +1,266 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/RealTime.hpp
+ *
+ * Real-time execution profile: SCHED_FIFO priorities and CPU pinning for the
+ * render, output and audio threads, and locked memory.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_REALTIME_HEADER
+#define BLINKENALGORITHMS_EXTRA_REALTIME_HEADER
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Process-wide registry of the threads of each role and the scheduling
+ * policy applied to them. Threads attach themselves, e.g. OutputThread as
+ * Output, and receive the role's policy immediately and whenever it is
+ * configured later, hence configuration and thread creation can happen in
+ * any order. Without configure() all threads keep SCHED_OTHER.
+ *
+ * Programs read the profile from the BLINKEN_RT environment variable, e.g.
+ * BLINKEN_RT=render=50:2,output=60:3,audio=70:1,mlock, and print report().
+ * Pinned CPUs should be isolated with isolcpus= on the kernel command line.
+ */
+class RealTime
+{
+public:
+    enum Role { Render = 0, Output = 1, Audio = 2, Roles = 3 };
+
+    //! Set the SCHED_FIFO priority (1-99, or 0 for SCHED_OTHER) and the CPU
+    //! (-1 to leave the affinity) of a role, and apply it to the role's
+    //! attached threads.
+    static void configure(Role role, int priority, int cpu = -1) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.policy[role].priority = priority;
+        s.policy[role].cpu = cpu;
+        for (Thread& t : s.threads) {
+            if (t.role == role)
+                apply(s.policy[role], t);
+        }
+    }
+
+    //! Configure from a comma separated list of role=priority[:cpu] and
+    //! mlock, returns false on syntax errors.
+    static bool configure(const std::string& spec) {
+        bool ok = true;
+        size_t begin = 0;
+        while (begin < spec.size()) {
+            size_t end = std::min(spec.find(',', begin), spec.size());
+            std::string item = spec.substr(begin, end - begin);
+            begin = end + 1;
+
+            if (item == "mlock") {
+                lock_memory();
+                continue;
+            }
+            size_t eq = item.find('=');
+            std::string name = item.substr(0, eq);
+            int role = 0;
+            while (role < Roles && name != role_name(Role(role)))
+                ++role;
+            if (eq == std::string::npos || role == Roles) {
+                ok = false;
+                continue;
+            }
+            const char* p = item.c_str() + eq + 1;
+            char* q;
+            int priority = strtol(p, &q, 10), cpu = -1;
+            if (*q == ':')
+                cpu = strtol(q + 1, &q, 10);
+            if (q == p || *q != 0 || priority < 0 || priority > 99) {
+                ok = false;
+                continue;
+            }
+            configure(Role(role), priority, cpu);
+        }
+        return ok;
+    }
+
+    //! Attach the calling thread as role, then configure the profile from
+    //! the BLINKEN_RT environment variable and report it, if it is set.
+    static void configure_from_env(Role self) {
+        attach_self(self);
+        const char* spec = getenv("BLINKEN_RT");
+        if (!spec)
+            return;
+        if (!configure(spec))
+            std::cerr << "invalid BLINKEN_RT=" << spec << std::endl;
+        report(std::cerr);
+    }
+
+    //! register a thread of a role and apply the role's current policy
+    static void attach(Role role, pthread_t thread) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.threads.push_back(Thread { role, thread, std::string() });
+        apply(s.policy[role], s.threads.back());
+    }
+
+    //! register the calling thread
+    static void attach_self(Role role) {
+        attach(role, pthread_self());
+    }
+
+    //! unregister a thread, must be called before it exits
+    static void detach(pthread_t thread) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.threads.erase(
+            std::remove_if(s.threads.begin(), s.threads.end(),
+                           [thread](const Thread& t) {
+                               return pthread_equal(t.thread, thread);
+                           }),
+            s.threads.end());
+    }
+
+    //! Lock all current and future pages into RAM and pre-fault stack_size
+    //! bytes of the calling thread's stack. Freed heap memory is kept instead
+    //! of returned to the kernel, such that later allocations of buffers do
+    //! not page fault either.
+    static bool lock_memory(size_t stack_size = 512 * 1024) {
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            s.memory = std::string("mlockall failed: ") + strerror(errno);
+            return false;
+        }
+        prefault_stack(stack_size);
+        s.memory = "locked, " + std::to_string(stack_size / 1024) +
+                   " KiB stack pre-faulted";
+        return true;
+    }
+
+    //! print the applied profile as a startup self-check
+    static void report(std::ostream& os) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        os << "real-time profile:" << std::endl
+           << "  memory: " << (s.memory.empty() ? "not locked" : s.memory)
+           << std::endl;
+        for (int r = 0; r < Roles; ++r) {
+            size_t n = 0;
+            for (const Thread& t : s.threads) {
+                if (t.role != r)
+                    continue;
+                os << "  " << role_name(Role(r)) << " thread " << n++ << ": "
+                   << t.result << std::endl;
+            }
+            if (n == 0 && (s.policy[r].priority || s.policy[r].cpu >= 0)) {
+                os << "  " << role_name(Role(r))
+                   << ": no thread attached yet" << std::endl;
+            }
+        }
+    }
+
+    static const char* role_name(Role role) {
+        static const char* names[Roles] = { "render", "output", "audio" };
+        return names[role];
+    }
+
+private:
+    struct Policy {
+        int priority = 0;
+        int cpu = -1;
+    };
+
+    struct Thread {
+        Role role;
+        pthread_t thread;
+        //! outcome of the last apply(), for report()
+        std::string result;
+    };
+
+    struct State {
+        std::mutex mutex;
+        Policy policy[Roles];
+        std::vector<Thread> threads;
+        std::string memory;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static void apply(const Policy& p, Thread& t) {
+        struct sched_param sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = p.priority;
+        int r = pthread_setschedparam(
+            t.thread, p.priority ? SCHED_FIFO : SCHED_OTHER, &sp);
+        t.result = p.priority ? "SCHED_FIFO " + std::to_string(p.priority)
+                   : std::string("SCHED_OTHER");
+        if (r != 0)
+            t.result += std::string(" failed: ") + strerror(r);
+
+        if (p.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(p.cpu, &set);
+            r = pthread_setaffinity_np(t.thread, sizeof(set), &set);
+            t.result += ", cpu " + std::to_string(p.cpu);
+            if (r != 0)
+                t.result += std::string(" failed: ") + strerror(r);
+            else if (!cpu_isolated(p.cpu))
+                t.result += " (not isolated)";
+        }
+    }
+
+    //! whether the cpu is in the kernel's isolcpus= list, e.g. "1,3-4"
+    static bool cpu_isolated(int cpu) {
+        std::ifstream in("/sys/devices/system/cpu/isolated");
+        std::string list;
+        std::getline(in, list);
+        const char* p = list.c_str();
+        while (*p) {
+            char* q;
+            long first = strtol(p, &q, 10), last = first;
+            if (q == p)
+                break;
+            if (*q == '-')
+                last = strtol(q + 1, &q, 10);
+            if (cpu >= first && cpu <= last)
+                return true;
+            p = (*q == ',') ? q + 1 : q;
+        }
+        return false;
+    }
+
+    //! touch stack pages once, mlockall() keeps them resident
+    static void prefault_stack(size_t size) {
+        volatile char* stack = static_cast<char*>(alloca(size));
+        for (size_t i = 0; i < size; i += 4096)
+            stack[i] = 0;
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_REALTIME_HEADER
+
+/******************************************************************************/
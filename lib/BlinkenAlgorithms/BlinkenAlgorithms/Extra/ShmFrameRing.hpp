@@ -0,0 +1,282 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Extra/ShmFrameRing.hpp
+ *
+ * Lock-free ring of frames in a /dev/shm file, written by one renderer and
+ * read by any number of consumer processes (output daemon, preview, ...).
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_EXTRA_SHMFRAMERING_HEADER
+#define BLINKENALGORITHMS_EXTRA_SHMFRAMERING_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Frame ring in shared memory. Frame f (counting from 1) is written into slot
+ * f % num_slots, which is guarded by a seqlock: its sequence word is 2f - 1
+ * while the frame is written and 2f once it is complete. Readers copy the
+ * latest frame and retry if the sequence word changed meanwhile, hence the
+ * writer never waits for readers. The latest frame number doubles as futex
+ * word to wake waiting readers.
+ */
+class ShmFrameRing
+{
+public:
+    static const uint32_t num_slots = 4;
+
+    ShmFrameRing() = default;
+
+    //! non-copyable: owns the mapping
+    ShmFrameRing(const ShmFrameRing&) = delete;
+    ShmFrameRing& operator = (const ShmFrameRing&) = delete;
+
+    ~ShmFrameRing() {
+        close();
+    }
+
+    //! Create /dev/shm/name as writer. The ring is built in a new file
+    //! which replaces any previous one by rename(): readers keep mapping the
+    //! previous file, which is never resized under them, and see it as
+    //! stale() once it is retired.
+    bool create(const std::string& name, size_t num_pixels) {
+        close();
+
+        std::string path = "/dev/shm/" + name;
+        std::string tmp = path + ".XXXXXX";
+        int fd = mkstemp(&tmp[0]);
+        if (fd < 0) {
+            std::cerr << "ShmFrameRing create " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+
+        size_t size = mapping_size(num_pixels);
+        if (fchmod(fd, 0644) < 0 || ftruncate(fd, size) < 0 ||
+            !map(fd, size, num_pixels, true)) {
+            std::cerr << "ShmFrameRing map " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            ::close(fd);
+            unlink(tmp.c_str());
+            return false;
+        }
+        ::close(fd);
+
+        header_->magic = 0;
+        header_->num_pixels = num_pixels_;
+        header_->slots = num_slots;
+        header_->latest.store(0, std::memory_order_relaxed);
+        for (uint32_t s = 0; s < num_slots; ++s)
+            header_->seq[s].store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->magic = magic_;
+
+        int old_fd = ::open(path.c_str(), O_WRONLY);
+        if (rename(tmp.c_str(), path.c_str()) < 0) {
+            std::cerr << "ShmFrameRing rename to " << path << " failed: "
+                      << strerror(errno) << std::endl;
+            if (old_fd >= 0)
+                ::close(old_fd);
+            close();
+            unlink(tmp.c_str());
+            return false;
+        }
+        if (old_fd >= 0) {
+            retire(old_fd);
+            ::close(old_fd);
+        }
+        return true;
+    }
+
+    //! attach to an existing /dev/shm/name as reader
+    bool attach(const std::string& name) {
+        close();
+
+        std::string path = "/dev/shm/" + name;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        Header h;
+        if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(Header) ||
+            pread(fd, &h, sizeof(h), 0) != sizeof(h) ||
+            h.magic != magic_ || h.slots != num_slots ||
+            size_t(st.st_size) < mapping_size(h.num_pixels) ||
+            !map(fd, mapping_size(h.num_pixels), h.num_pixels, false)) {
+            ::close(fd);
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }
+
+    void close() {
+        if (header_)
+            munmap(header_, size_);
+        header_ = nullptr;
+        num_pixels_ = 0;
+    }
+
+    bool is_open() const { return header_ != nullptr; }
+
+    //! number of pixels per frame at the time of mapping
+    size_t num_pixels() const { return num_pixels_; }
+
+    //! whether the writer has since recreated the ring with another layout,
+    //! readers must then attach() again
+    bool stale() const {
+        return header_->magic != magic_ ||
+               header_->num_pixels != num_pixels_;
+    }
+
+    //! number of the latest complete frame, 0 if none yet
+    uint32_t latest() const {
+        return header_->latest.load(std::memory_order_acquire);
+    }
+
+    //! publish a frame of up to num_pixels() colors and wake readers
+    void publish(const Color* colors, size_t n) {
+        uint32_t f = header_->latest.load(std::memory_order_relaxed) + 1;
+        if (f == 0)
+            f = 1;
+        std::atomic<uint32_t>& seq = header_->seq[f % num_slots];
+
+        seq.store(2 * f - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        n = std::min(n, num_pixels_);
+        memcpy(slot(f), colors, n * sizeof(Color));
+
+        seq.store(2 * f, std::memory_order_release);
+        header_->latest.store(f, std::memory_order_release);
+
+        syscall(SYS_futex, &header_->latest, FUTEX_WAKE, INT_MAX,
+                nullptr, nullptr, 0);
+    }
+
+    //! Copy the latest complete frame into dst (num_pixels() colors). Sets
+    //! frame to its number, returns false if there is no frame yet.
+    bool read(Color* dst, uint32_t& frame) const {
+        size_t bytes = num_pixels_ * sizeof(Color);
+        while (true) {
+            uint32_t f = header_->latest.load(std::memory_order_acquire);
+            frame = f;
+            if (f == 0)
+                return false;
+
+            const std::atomic<uint32_t>& seq = header_->seq[f % num_slots];
+            uint32_t s1 = seq.load(std::memory_order_acquire);
+            if (s1 != 2 * f)
+                continue;
+
+            memcpy(dst, slot(f), bytes);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1)
+                return true;
+        }
+    }
+
+    //! Block until a frame newer than last is published or timeout_us
+    //! passed. Returns true if there is a newer frame.
+    bool wait(uint32_t last, uint32_t timeout_us) const {
+        if (latest() != last)
+            return true;
+
+        struct timespec ts;
+        ts.tv_sec = timeout_us / 1000000;
+        ts.tv_nsec = (timeout_us % 1000000) * 1000;
+        syscall(SYS_futex, &header_->latest, FUTEX_WAIT, last,
+                &ts, nullptr, 0);
+
+        return latest() != last;
+    }
+
+private:
+    static const uint32_t magic_ = 0x424C4B46; // "BLKF"
+
+    //! shared header, pixel slots follow at header_size_
+    struct Header {
+        uint32_t magic;
+        uint32_t num_pixels;
+        uint32_t slots;
+        uint32_t reserved;
+        std::atomic<uint32_t> latest;
+        std::atomic<uint32_t> seq[num_slots];
+    };
+
+    //! header padded to a cache line
+    static const size_t header_size_ = 64;
+
+    static_assert(sizeof(Header) <= header_size_, "header too large");
+
+    Header* header_ = nullptr;
+
+    size_t size_ = 0;
+
+    //! pixels per frame of the mapping
+    size_t num_pixels_ = 0;
+
+    //! Clear the magic of a replaced ring file, such that its readers attach
+    //! again. Only the header word is written, the file keeps its size.
+    static void retire(int fd) {
+        struct stat st;
+        uint32_t zero = 0;
+        // magic is the first word of the header
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header) &&
+            pwrite(fd, &zero, sizeof(zero), 0) != sizeof(zero)) {
+            std::cerr << "ShmFrameRing retire failed: "
+                      << strerror(errno) << std::endl;
+        }
+    }
+
+    static size_t mapping_size(size_t num_pixels) {
+        return header_size_ + num_slots * num_pixels * sizeof(Color);
+    }
+
+    bool map(int fd, size_t size, size_t num_pixels, bool writable) {
+        void* p = mmap(nullptr, size,
+                       writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            return false;
+        header_ = static_cast<Header*>(p);
+        size_ = size;
+        num_pixels_ = num_pixels;
+        return true;
+    }
+
+    Color* slot(uint32_t f) const {
+        uint8_t* base = reinterpret_cast<uint8_t*>(header_) + header_size_;
+        return reinterpret_cast<Color*>(
+            base + (f % num_slots) * num_pixels_ * sizeof(Color));
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_EXTRA_SHMFRAMERING_HEADER
+
+/******************************************************************************/
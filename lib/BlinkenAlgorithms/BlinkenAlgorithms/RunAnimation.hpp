@@ -9,8 +9,11 @@
 #ifndef BLINKENALGORITHMS_RUNANIMATION_HEADER
 #define BLINKENALGORITHMS_RUNANIMATION_HEADER
 
+#include <BlinkenAlgorithms/Trace.hpp>
+
 #include <algorithm>
 #include <cstdint>
+#include <vector>
 
 extern bool g_terminate;
 extern void delay_poll();
@@ -23,177 +26,232 @@ static const uint32_t NoUpdate = uint32_t(-2);
 
 /******************************************************************************/
 
-template <typename Animation1>
-void RunAnimation(Animation1&& ani1, size_t time_limit) {
-    uint32_t ts_end = micros() + 1000 * time_limit;
-    g_terminate = false;
-
-    for (uint32_t s = 0; micros() < ts_end; ++s) {
-        uint32_t d = ani1(s);
-
-        if (d == EndAnimation)
-            break;
-        else if (d == NoUpdate)
-            d = 0;
-        else {
-            if (!ani1.strip_.busy()) {
-                ani1.strip_.show();
-            }
-        }
-
-        delay_micros(d);
-
-        if (g_terminate)
-            break;
-
-        delay_poll();
+//! timing statistics of one animation run by AnimationScheduler
+struct AnimationStats {
+    //! number of frames drawn
+    size_t frames = 0;
+    //! frames skipped to keep pace after overruns
+    size_t skipped = 0;
+    //! sum and maximum of the microseconds frames started after deadline
+    uint64_t lateness_sum = 0;
+    uint32_t lateness_max = 0;
+    //! frames started late by < 100 us, < 1 ms, < 10 ms, and more
+    size_t lateness_hist[4] = { 0, 0, 0, 0 };
+
+    void add_lateness(uint64_t late) {
+        ++frames;
+        lateness_sum += late;
+        if (late > lateness_max)
+            lateness_max = late < UINT32_MAX ? uint32_t(late) : UINT32_MAX;
+        size_t b = 0;
+        for (uint64_t limit = 100; b < 3 && late >= limit; limit *= 10)
+            ++b;
+        ++lateness_hist[b];
     }
-}
-
-template <typename Animation1, typename Animation2>
-void RunAnimation(Animation1&& ani1, Animation2&& ani2, size_t time_limit) {
-    uint32_t ts_end = micros() + 1000 * time_limit;
-    uint32_t s1 = 0, s2 = 0;
-    uint32_t d1 = 0, d2 = 0;
-    bool dirty1 = false, dirty2 = false;
 
-    g_terminate = false;
-
-    while (true) {
-        uint32_t ts = micros();
-        if (ts_end < ts)
-            break;
+    //! mean microseconds frames started after deadline
+    double lateness_mean() const {
+        return frames ? double(lateness_sum) / frames : 0.0;
+    }
+};
+
+/*!
+ * Runs any number of animations, each on its own strip or several on a shared
+ * strip. Animations are kept in a min-heap keyed by their next 64-bit
+ * deadline, which is the previous deadline plus the delay the animation
+ * returned, hence periods do not stretch by the time spent drawing and
+ * showing. Strips are shown at most once per round, after all due animations
+ * drew into them.
+ *
+ * A frame which overruns its period delays the next by at most one period:
+ * the next frame starts immediately, and if a whole period or more was missed
+ * the missed frames are skipped. Deadlines hence stay on the grid of the
+ * animation's start time.
+ */
+class AnimationScheduler
+{
+public:
+    //! add an animation drawing into its member strip_
+    template <typename Animation>
+    void add(Animation& ani) {
+        Task t;
+        t.ani = &ani;
+        t.step = [](void* a, uint32_t s) -> uint32_t {
+                     return (*static_cast<Animation*>(a))(s);
+                 };
+        t.output = add_output(ani.strip_);
+        tasks_.push_back(t);
+    }
 
-        if (d1 < ts) {
-            uint32_t d = ani1(s1++);
-            if (d == EndAnimation) {
-                d1 = EndAnimation;
-            }
-            else if (d == NoUpdate) { }
-            else {
-                d1 += d;
-                dirty1 = true;
-            }
-        }
-        if (d2 < ts) {
-            uint32_t d = ani2(s2++);
-            if (d == EndAnimation) {
-                d2 = EndAnimation;
+    //! run until all animations ended, time_limit milliseconds passed, or
+    //! g_terminate is set
+    void run(size_t time_limit) {
+        uint64_t ts = micros64();
+        uint64_t ts_end = ts + 1000 * uint64_t(time_limit);
+        g_terminate = false;
+
+        // allocate the heap once instead of while running
+        heap_.clear();
+        heap_.reserve(tasks_.size());
+        due_.reserve(tasks_.size());
+        for (size_t i = 0; i < tasks_.size(); ++i)
+            heap_.push_back(Deadline { ts, i });
+
+        while (!heap_.empty()) {
+            ts = micros64();
+            if (ts >= ts_end)
+                break;
+
+            // take all due animations off the heap before running them, such
+            // that NoUpdate cannot rerun an animation within this round
+            due_.clear();
+            while (!heap_.empty() && heap_.front().ts <= ts) {
+                std::pop_heap(heap_.begin(), heap_.end(), later);
+                due_.push_back(heap_.back());
+                heap_.pop_back();
             }
-            else if (d == NoUpdate) { }
-            else {
-                d2 += d;
-                dirty2 = true;
-            }
-        }
 
-        if (dirty1 && !ani1.strip_.busy()) {
-            ani1.strip_.show();
-            dirty1 = false;
-        }
-        if (dirty2 && !ani2.strip_.busy()) {
-            ani2.strip_.show();
-            dirty2 = false;
-        }
+            for (Deadline& d : due_) {
+                Task& t = tasks_[d.task];
+                uint32_t r;
+                {
+                    BLINKEN_TRACE_SPAN("step");
+                    r = t.step(t.ani, t.s++);
+                }
+                if (r == EndAnimation)
+                    continue;
+                if (r == NoUpdate) {
+                    d.ts = ts;
+                }
+                else {
+                    t.stats.add_lateness(ts - d.ts);
+                    // a zero delay redraws as soon as possible: restart the
+                    // grid now instead of accumulating lateness
+                    d.ts = r == 0 ? ts : d.ts + r;
+                    if (r != 0 && d.ts + r <= ts) {
+                        // skip missed frames instead of catching up in a burst
+                        uint64_t missed = (ts - d.ts) / r;
+                        d.ts += missed * r;
+                        t.stats.skipped += missed;
+                        // advance the animation as if it drew them
+                        t.s += missed;
+                    }
+                    outputs_[t.output].dirty = true;
+                }
+                heap_.push_back(d);
+                std::push_heap(heap_.begin(), heap_.end(), later);
+            }
 
-        uint32_t d = std::min(d1, d2);
-        if (d >= ts)
-            delay_micros(d - ts);
+            // show each changed strip once, or retry in the next round while
+            // its previous frame is still being sent
+            bool pending = false;
+            for (Output& o : outputs_) {
+                if (!o.dirty)
+                    continue;
+                if (o.busy(o.strip)) {
+                    pending = true;
+                    continue;
+                }
+                {
+                    BLINKEN_TRACE_SPAN("show");
+                    o.show(o.strip);
+                }
+                o.dirty = false;
+            }
 
-        if (d1 == EndAnimation && d2 == EndAnimation)
-            break;
+            if (g_terminate)
+                break;
 
-        if (g_terminate)
-            break;
+            delay_poll();
 
-        delay_poll();
-    }
-}
+            if (heap_.empty())
+                break;
 
-template <template <class> class Animation1,
-          template <class> class Animation2,
-          template <class> class Animation3,
-          typename LEDStrip1,
-          typename LEDStrip2,
-          typename LEDStrip3>
-void RunAnimation(LEDStrip1& strip1, LEDStrip2& strip2,
-                  LEDStrip2& strip3,
-                  size_t time_limit) {
-    Animation1<LEDStrip1> ani1(strip1);
-    Animation2<LEDStrip2> ani2(strip2);
-    Animation3<LEDStrip3> ani3(strip3);
-    uint32_t ts_end = micros() + 1000 * time_limit;
-    uint32_t s1 = 0, s2 = 0, s3 = 0;
-    uint32_t d1 = 0, d2 = 0, d3 = 0;
-    bool dirty1 = false, dirty2 = false, dirty3 = false;
-
-    g_terminate = false;
-
-    while (true) {
-        uint32_t ts = micros();
-        if (ts_end < ts)
-            break;
-
-        if (d1 < ts) {
-            uint32_t d = ani1(strip1, s1++);
-            if (d == EndAnimation) {
-                d1 = EndAnimation;
-            }
-            else if (d == NoUpdate) { }
-            else {
-                d1 += d;
-                dirty1 = true;
-            }
-        }
-        if (d2 < ts) {
-            uint32_t d = ani2(strip2, s2++);
-            if (d == EndAnimation) {
-                d2 = EndAnimation;
-            }
-            else if (d == NoUpdate) { }
-            else {
-                d2 += d;
-                dirty2 = true;
-            }
-        }
-        if (d3 < ts) {
-            uint32_t d = ani3(strip3, s3++);
-            if (d == EndAnimation) {
-                d3 = EndAnimation;
-            }
-            else if (d == NoUpdate) { }
-            else {
-                d3 += d;
-                dirty3 = true;
+            uint64_t next = std::min(heap_.front().ts, ts_end);
+            if (pending)
+                next = std::min(next, ts + busy_poll);
+            if (next > micros64()) {
+                BLINKEN_TRACE_SPAN("sleep");
+                delay_until_micros64(next);
             }
         }
+    }
 
-        if (dirty1 && !strip1.busy()) {
-            strip1.show();
-            dirty1 = false;
-        }
-        if (dirty2 && !strip2.busy()) {
-            strip2.show();
-            dirty2 = false;
-        }
-        if (dirty3 && !strip3.busy()) {
-            strip3.show();
-            dirty3 = false;
-        }
-
-        uint32_t d = std::min(std::min(d1, d2), d3);
-        if (d >= ts)
-            strip1.micros(d - ts);
-
-        if (d1 == EndAnimation && d2 == EndAnimation &&
-            d3 == EndAnimation)
-            break;
-
-        if (g_terminate)
-            break;
+    //! number of animations added
+    size_t size() const { return tasks_.size(); }
+
+    //! timing statistics of the i-th animation added
+    const AnimationStats& stats(size_t i) const { return tasks_[i].stats; }
+
+private:
+    //! interval in microseconds to poll a busy strip with a pending frame
+    static const uint32_t busy_poll = 1000;
+
+    struct Task {
+        void* ani;
+        uint32_t (*step)(void*, uint32_t);
+        //! step counter passed to the animation
+        uint32_t s = 0;
+        //! index into outputs_
+        size_t output;
+        AnimationStats stats;
+    };
+
+    struct Output {
+        void* strip;
+        void (*show)(void*);
+        bool (*busy)(void*);
+        //! whether an animation drew a frame not shown yet
+        bool dirty;
+    };
+
+    struct Deadline {
+        uint64_t ts;
+        size_t task;
+    };
+
+    std::vector<Task> tasks_;
+    std::vector<Output> outputs_;
+    std::vector<Deadline> heap_, due_;
+
+    //! heap order: earliest deadline at the front
+    static bool later(const Deadline& a, const Deadline& b) {
+        return a.ts > b.ts;
+    }
 
-        delay_poll();
+    //! find or add the output entry of a strip, animations drawing into the
+    //! same strip share it
+    template <typename LEDStrip>
+    size_t add_output(LEDStrip& strip) {
+        for (size_t i = 0; i < outputs_.size(); ++i) {
+            if (outputs_[i].strip == &strip)
+                return i;
+        }
+        Output o;
+        o.strip = &strip;
+        o.show = [](void* p) { static_cast<LEDStrip*>(p)->show(); };
+        o.busy = [](void* p) { return static_cast<LEDStrip*>(p)->busy(); };
+        o.dirty = false;
+        outputs_.push_back(o);
+        return outputs_.size() - 1;
     }
+};
+
+//! run animations concurrently for time_limit milliseconds, returns their
+//! timing statistics in argument order
+template <typename... Animations>
+std::vector<AnimationStats>
+RunAnimation(size_t time_limit, Animations&& ... anis) {
+    AnimationScheduler sched;
+    // expand the pack in an initializer list, evaluated in order
+    int expand[] = { 0, (sched.add(anis), 0) ... };
+    (void)expand;
+    sched.run(time_limit);
+
+    std::vector<AnimationStats> stats;
+    for (size_t i = 0; i < sched.size(); ++i)
+        stats.push_back(sched.stats(i));
+    return stats;
 }
 
 } // namespace BlinkenAlgorithms
@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/APA102Encoder.hpp
+ *
+ * Transform RGBW colors into APA102 RGB + 5-bit global brightness frames
+ * without divisions, using reciprocal tables keyed by the brightness level.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_APA102ENCODER_HEADER
+#define BLINKENALGORITHMS_STRIP_APA102ENCODER_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Strip/PixelFormat.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace BlinkenAlgorithms {
+
+//! APA102 pixel in wire order: brightness header, blue, green, red. Strips
+//! with another color order permute r, g and b, which all per-channel
+//! operations treat alike.
+struct APAColor {
+    uint8_t w = 0, b = 0, g = 0, r = 0;
+
+    bool operator == (const APAColor& o) const {
+        return w == o.w && b == o.b && g == o.g && r == o.r;
+    }
+    bool operator != (const APAColor& o) const {
+        return !operator == (o);
+    }
+};
+
+/*!
+ * APA102 wire format: a header byte with the 5-bit global brightness, then
+ * the three colors in ColorOrder, BGR on most APA102 and SK9822 strips. White
+ * is folded into the colors and the brightness is chosen by APA102Encoder.
+ */
+template <typename ColorOrder = PixelFormatBGR>
+struct PixelFormatAPA102 {
+    static_assert(!ColorOrder::has_white, "APA102 has no white channel");
+
+    static const bool has_white = false;
+
+    //! wire bytes per pixel
+    static const size_t bytes = 4;
+
+    //! place header and channels at their wire positions
+    static void pack(APAColor& a, uint8_t header,
+                     uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(&a);
+        p[0] = header;
+        p[1 + ColorOrder::r_pos] = r;
+        p[1 + ColorOrder::g_pos] = g;
+        p[1 + ColorOrder::b_pos] = b;
+    }
+};
+
+class APA102Encoder
+{
+public:
+    //! Encode gamma corrected RGB sums (each 0..510, RGB plus white) into
+    //! RGB + brightness. Exactly matches the previous formula
+    //!   m = (((max + 1) * 31 - 1) >> 8) + 1, c = (31 * c + m / 2) / m
+    //! but replaces the divisions by a multiplication with a reciprocal.
+    template <typename Format = PixelFormatAPA102<> >
+    static APAColor encode(unsigned r, unsigned g, unsigned b) {
+        const Level& l = levels()[std::max(std::max(r, g), b)];
+
+        r = ((mm_ * r + l.half) * l.recip) >> recip_shift_;
+        g = ((mm_ * g + l.half) * l.recip) >> recip_shift_;
+        b = ((mm_ * b + l.half) * l.recip) >> recip_shift_;
+
+        APAColor a;
+        Format::pack(a, l.header, r > 255 ? 255 : r, g > 255 ? 255 : g,
+                     b > 255 ? 255 : b);
+        return a;
+    }
+
+    //! Encode RGBW color after applying gamma table.
+    template <typename Format = PixelFormatAPA102<> >
+    static APAColor encode(const Color& c, const uint8_t* gamma) {
+        unsigned w = gamma[c.w];
+        return encode<Format>(gamma[c.r] + w, gamma[c.g] + w, gamma[c.b] + w);
+    }
+
+    //! Encode a run of colors. Table lookups are done per pixel, the
+    //! multiply/shift/clamp arithmetic is done four pixels at a time with GCC
+    //! vector extensions, which lower to NEON on the Pi and SSE on x86.
+    template <typename Format = PixelFormatAPA102<> >
+    static void encode(APAColor* dst, const Color* src, size_t n,
+                       const uint8_t* gamma) {
+        const Level* levels = APA102Encoder::levels();
+
+        size_t i = 0;
+        for ( ; i + 4 <= n; i += 4) {
+            v4u32 r, g, b, half, recip;
+            uint8_t header[4];
+
+            for (size_t k = 0; k < 4; ++k) {
+                const Color& c = src[i + k];
+                unsigned w = gamma[c.w];
+                unsigned cr = gamma[c.r] + w;
+                unsigned cg = gamma[c.g] + w;
+                unsigned cb = gamma[c.b] + w;
+
+                const Level& l = levels[std::max(std::max(cr, cg), cb)];
+                r[k] = cr, g[k] = cg, b[k] = cb;
+                half[k] = l.half, recip[k] = l.recip;
+                header[k] = l.header;
+            }
+
+            r = ((mm_ * r + half) * recip) >> recip_shift_;
+            g = ((mm_ * g + half) * recip) >> recip_shift_;
+            b = ((mm_ * b + half) * recip) >> recip_shift_;
+
+            r = clamp255(r), g = clamp255(g), b = clamp255(b);
+
+            for (size_t k = 0; k < 4; ++k)
+                Format::pack(dst[i + k], header[k], r[k], g[k], b[k]);
+        }
+        for ( ; i < n; ++i) {
+            dst[i] = encode<Format>(src[i], gamma);
+        }
+    }
+
+private:
+    //! maximum brightness level of APA102's global brightness field
+    static const unsigned mm_ = 0x1F;
+
+    //! fixed-point precision of reciprocals, exact for all numerators
+    static const unsigned recip_shift_ = 20;
+
+    typedef uint32_t v4u32 __attribute__ ((vector_size(16)));
+
+    static v4u32 clamp255(v4u32 v) {
+        v4u32 over = (v4u32)(v > 255);
+        return (v & ~over) | (255 & over);
+    }
+
+    //! precalculated values for one maximum channel value
+    struct Level {
+        //! ceil(2^recip_shift_ / m)
+        uint32_t recip;
+        //! rounding term m / 2
+        uint32_t half;
+        //! APA102 header byte with clamped brightness m
+        uint8_t header;
+    };
+
+    //! table keyed by the maximum of the three RGB sums (0..510)
+    static const Level* levels() {
+        static const LevelTable s_table;
+        return s_table.levels;
+    }
+
+    struct LevelTable {
+        Level levels[2 * 255 + 1];
+
+        LevelTable() {
+            for (unsigned max = 0; max < 2 * 255 + 1; ++max) {
+                unsigned m = (((max + 1) * mm_ - 1) >> 8) + 1;
+                levels[max].recip =
+                    ((uint32_t(1) << recip_shift_) + m - 1) / m;
+                levels[max].half = m >> 1;
+                levels[max].header = 0b11100000 | (m > 31 ? 31 : m);
+            }
+        }
+    };
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_APA102ENCODER_HEADER
+
+/******************************************************************************/
@@ -25,8 +25,14 @@ public:
         return strip_.numPixels();
     }
 
-    void show() const {
-        return strip_.show();
+    //! show frame, skipped if no pixel changed
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+        strip_.show();
+        clear_dirty();
     }
 
     bool busy() {
@@ -34,16 +40,62 @@ public:
     }
 
     void setPixel(size_t i, const Color& c) {
-        strip_.setPixelColor(i, gamma8(c.r), gamma8(c.g),
-                             gamma8(c.b), gamma8(c.w));
+        setPixelRaw(i, Adafruit_NeoPixel::Color(
+                        gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w)));
+    }
+
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            setPixel(first + i, colors[i]);
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const Color& c = colors[i];
+            setPixelRaw(first + i,
+                        Adafruit_NeoPixel::Color(c.r, c.g, c.b, c.w));
+        }
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < size(); ++i)
+            setPixelRaw(i, 0);
     }
 
     Color getPixel(size_t i) const {
         return ColorRGBW(strip_.getPixelColor(i));
     }
 
+    //! copy a pixel without gamma correcting it again
+    void copyPixel(size_t dst, size_t src) {
+        if (src < size())
+            setPixelRaw(dst, strip_.getPixelColor(src));
+    }
+
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst <= src) {
+            for (size_t i = 0; i < n; ++i)
+                copyPixel(dst + i, src + i);
+        }
+        else {
+            for (size_t i = n; i != 0; --i)
+                copyPixel(dst + i - 1, src + i - 1);
+        }
+    }
+
 private:
     Adafruit_NeoPixel& strip_;
+
+    //! store packed color, marking it dirty if it changed
+    void setPixelRaw(size_t i, uint32_t c) {
+        if (i < size() && strip_.getPixelColor(i) != c) {
+            strip_.setPixelColor(i, c);
+            mark_dirty(i);
+        }
+    }
 };
 
 } // namespace BlinkenAlgorithms
@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/Framebuffer.hpp
+ *
+ * In-memory render target: a contiguous, aligned array of colors with bulk
+ * operations, which is handed to a strip driver in one pass per frame.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_FRAMEBUFFER_HEADER
+#define BLINKENALGORITHMS_STRIP_FRAMEBUFFER_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Contiguous array of colors implementing the strip interface without gamma
+ * correction or encoding. The bulk operations are plain byte loops over the
+ * aligned array, which compilers vectorize (e.g. add becomes a saturating
+ * vector add).
+ */
+class Framebuffer : public LEDStripBase
+{
+public:
+    explicit Framebuffer(size_t size)
+        : size_(size),
+          storage_(new uint8_t[size * sizeof(Color) + alignment_]) {
+        uintptr_t p = reinterpret_cast<uintptr_t>(storage_.get());
+        p = (p + alignment_ - 1) & ~uintptr_t(alignment_ - 1);
+        data_ = reinterpret_cast<Color*>(p);
+        clear();
+    }
+
+    //! non-copyable: use copy() to copy contents
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator = (const Framebuffer&) = delete;
+
+    size_t size() const { return size_; }
+
+    Color* data() { return data_; }
+    const Color* data() const { return data_; }
+
+    //! nothing to show, see FramebufferStrip
+    void show() { }
+    bool busy() const { return false; }
+
+    Color getPixel(size_t i) const {
+        return i < size_ ? data_[i] : Color(0);
+    }
+
+    void setPixel(size_t i, const Color& c) {
+        if (i < size_)
+            data_[i] = c;
+    }
+
+    void orPixel(size_t i, const Color& c) {
+        if (i < size_)
+            data_[i] = data_[i] | c;
+    }
+
+    void addPixel(size_t i, const Color& c) {
+        if (i < size_)
+            data_[i] = data_[i] + c;
+    }
+
+    void copyPixel(size_t dst, size_t src) {
+        if (dst < size_ && src < size_)
+            data_[dst] = data_[src];
+    }
+
+    //! copy a run of pixels, ranges may overlap
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= size_ || src >= size_)
+            return;
+        n = std::min(n, size_ - std::max(dst, src));
+        memmove(data_ + dst, data_ + src, n * sizeof(Color));
+    }
+
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        if (first >= size_)
+            return;
+        n = std::min(n, size_ - first);
+        memcpy(data_ + first, colors, n * sizeof(Color));
+    }
+
+    /**************************************************************************/
+    // Bulk Operations
+
+    //! set all pixels to black
+    void clear() {
+        memset(data_, 0, size_ * sizeof(Color));
+    }
+
+    //! set all pixels to c
+    void fill(const Color& c) {
+        uint32_t* __restrict d = reinterpret_cast<uint32_t*>(data_);
+        const uint32_t v = c.v;
+        for (size_t i = 0; i < size_; ++i)
+            d[i] = v;
+    }
+
+    //! copy pixels of another framebuffer, up to the smaller size
+    void copy(const Framebuffer& src) {
+        memcpy(data_, src.data_, std::min(size_, src.size_) * sizeof(Color));
+    }
+
+    //! saturating add of another framebuffer
+    void add(const Framebuffer& src) {
+        uint8_t* __restrict d = bytes();
+        const uint8_t* __restrict s = src.bytes();
+        size_t n = std::min(size_, src.size_) * sizeof(Color);
+        for (size_t i = 0; i < n; ++i) {
+            unsigned x = d[i] + s[i];
+            d[i] = x > 255 ? 255 : x;
+        }
+    }
+
+    //! bitwise or of another framebuffer
+    void bitOr(const Framebuffer& src) {
+        uint8_t* __restrict d = bytes();
+        const uint8_t* __restrict s = src.bytes();
+        size_t n = std::min(size_, src.size_) * sizeof(Color);
+        for (size_t i = 0; i < n; ++i)
+            d[i] |= s[i];
+    }
+
+    //! scale all channels by factor / 256, 255 keeps the colors
+    void scale(uint8_t factor) {
+        uint8_t* __restrict d = bytes();
+        const unsigned f = factor + 1u;
+        size_t n = size_ * sizeof(Color);
+        for (size_t i = 0; i < n; ++i)
+            d[i] = (d[i] * f) >> 8;
+    }
+
+private:
+    //! alignment of the array: one 128-bit vector register
+    static const size_t alignment_ = 16;
+
+    //! number of pixels
+    size_t size_;
+
+    //! allocated memory
+    std::unique_ptr<uint8_t[]> storage_;
+
+    //! aligned pixels inside storage_
+    Color* data_;
+
+    uint8_t* bytes() {
+        return reinterpret_cast<uint8_t*>(data_);
+    }
+    const uint8_t* bytes() const {
+        return reinterpret_cast<const uint8_t*>(data_);
+    }
+};
+
+/*!
+ * Framebuffer in front of a strip: animations render into memory and show()
+ * hands the whole frame to the strip's setPixels() in one bulk encode pass.
+ * The strip's own change detection then skips unchanged pixels and frames.
+ */
+template <typename BaseStrip>
+class FramebufferStrip : public Framebuffer
+{
+public:
+    explicit FramebufferStrip(BaseStrip& base)
+        : Framebuffer(base.size()), base_(base) { }
+
+    void show() {
+        base_.setPixels(0, data(), size());
+        base_.show();
+    }
+
+    bool busy() const {
+        return base_.busy();
+    }
+
+    uint8_t intensity() const {
+        return base_.intensity();
+    }
+    void set_intensity(uint8_t intensity) {
+        return base_.set_intensity(intensity);
+    }
+
+    size_t skipped_frames() const {
+        return base_.skipped_frames();
+    }
+
+    BaseStrip& base() { return base_; }
+
+private:
+    BaseStrip& base_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_FRAMEBUFFER_HEADER
+
+/******************************************************************************/
@@ -9,7 +9,11 @@
 #ifndef BLINKENALGORITHMS_STRIP_LEDSTRIPBASE_HEADER
 #define BLINKENALGORITHMS_STRIP_LEDSTRIPBASE_HEADER
 
+#include <BlinkenAlgorithms/Color.hpp>
+
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <initializer_list>
 
 namespace BlinkenAlgorithms {
@@ -29,6 +33,11 @@ public:
     }
 
     uint8_t gamma8(uint8_t v) const {
+        return gamma8_table()[v];
+    }
+
+    //! gamma correction table used by gamma8()
+    static const uint8_t* gamma8_table() {
         static const uint8_t s_gamma8[256] = {
             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1,
@@ -52,11 +61,77 @@ public:
             215, 218, 220, 223, 225, 228, 231, 233,
             236, 239, 241, 244, 247, 249, 252, 255
         };
-        return s_gamma8[v];
+        return s_gamma8;
+    }
+
+    //! identity table, for colors which are already gamma corrected
+    static const uint8_t* linear8_table() {
+        static const LinearTable s_table;
+        return s_table.values;
+    }
+
+    // Dirty tracking: drivers record the range of pixels whose encoded value
+    // changed since the last transmitted frame. show() skips unchanged frames,
+    // and drivers supporting partial updates only send the changed span.
+
+    //! whether any pixel changed since the last show()
+    bool dirty() const {
+        return dirty_begin_ < dirty_end_;
+    }
+
+    //! first changed pixel
+    size_t dirty_begin() const {
+        return dirty_begin_;
+    }
+
+    //! one past the last changed pixel
+    size_t dirty_end() const {
+        return dirty_end_;
+    }
+
+    //! mark pixel i as changed
+    void mark_dirty(size_t i) {
+        dirty_begin_ = std::min(dirty_begin_, i);
+        dirty_end_ = std::max(dirty_end_, i + 1);
+    }
+
+    //! mark pixels [begin,end) as changed
+    void mark_dirty(size_t begin, size_t end) {
+        if (begin >= end)
+            return;
+        dirty_begin_ = std::min(dirty_begin_, begin);
+        dirty_end_ = std::max(dirty_end_, end);
+    }
+
+    //! called by drivers once the frame has been transmitted
+    void clear_dirty() {
+        dirty_begin_ = size_t(-1);
+        dirty_end_ = 0;
+    }
+
+    //! number of show() calls skipped because no pixel changed
+    size_t skipped_frames() const {
+        return skipped_frames_;
     }
 
 protected:
     uint8_t intensity_ = 96;
+
+    //! changed range, initially everything such that the first frame is sent
+    size_t dirty_begin_ = 0, dirty_end_ = size_t(-1);
+
+    //! counter of skipped unchanged frames
+    size_t skipped_frames_ = 0;
+
+private:
+    struct LinearTable {
+        uint8_t values[256];
+
+        LinearTable() {
+            for (unsigned v = 0; v < 256; ++v)
+                values[v] = v;
+        }
+    };
 };
 
 /******************************************************************************/
@@ -87,6 +162,10 @@ public:
         return base_.set_intensity(intensity);
     }
 
+    size_t skipped_frames() const {
+        return base_.skipped_frames();
+    }
+
 protected:
     BaseStrip& base_;
 };
@@ -108,14 +187,33 @@ public:
         return base_.size() / Repeat;
     }
 
+    //! encode each pixel once and copy the encoded value to its mirrors
     void setPixel(size_t i, const Color& c) {
-        for (size_t r = 0; r < Repeat; ++r) {
-            base_.setPixel(Repeat * i + r, c);
+        base_.setPixel(Repeat * i, c);
+        for (size_t r = 1; r < Repeat; ++r) {
+            base_.copyPixel(Repeat * i + r, Repeat * i);
         }
     }
     void orPixel(size_t i, const Color& c) {
+        base_.orPixel(Repeat * i, c);
+        for (size_t r = 1; r < Repeat; ++r) {
+            base_.copyPixel(Repeat * i + r, Repeat * i);
+        }
+    }
+    void addPixel(size_t i, const Color& c) {
+        base_.addPixel(Repeat * i, c);
+        for (size_t r = 1; r < Repeat; ++r) {
+            base_.copyPixel(Repeat * i + r, Repeat * i);
+        }
+    }
+
+    void clear() {
+        base_.clear();
+    }
+
+    void copyPixel(size_t dst, size_t src) {
         for (size_t r = 0; r < Repeat; ++r) {
-            base_.orPixel(Repeat * i + r, c);
+            base_.copyPixel(Repeat * dst + r, Repeat * src + r);
         }
     }
 };
@@ -161,59 +259,13 @@ public:
         strips_[i % NumStrips]->orPixel(i / NumStrips, c);
     }
 
-    BaseStrip* strips_[NumStrips];
-};
-
-/******************************************************************************/
-// Milliways Dome @ EMF 2018
-
-template <typename BaseStrip>
-class LEDMultiDomeStrip : public BaseStrip
-{
-public:
-    LEDMultiDomeStrip(BaseStrip& base)
-        : BaseStrip(base) { }
-
-    size_t size() { return 300; }
-
-    void setPixel(size_t i, const Color& c) {
-        for (size_t s = 0; s < 5; ++s) {
-            BaseStrip::setPixel(s * 300 + i, c);
-        }
-    }
-};
-
-template <typename BaseStrip>
-class LEDDomeFFTStrip : public BaseStrip
-{
-public:
-    LEDDomeFFTStrip(BaseStrip& base)
-        : BaseStrip(base) { }
-
-    size_t size() { return 260; }
-
-    void setPixel(size_t i, const Color& c) {
-        for (size_t s = 0; s < 5; ++s) {
-            BaseStrip::setPixel(s * 300 + 260 - 1 - i, c);
+    void clear() {
+        for (size_t s = 0; s < NumStrips; ++s) {
+            strips_[s]->clear();
         }
     }
-};
 
-template <typename BaseStrip>
-class LEDDomeBarStrip : public BaseStrip
-{
-public:
-    LEDDomeBarStrip(BaseStrip& base)
-        : BaseStrip(base) { }
-
-    size_t size() { return 600; }
-
-    void setPixel(size_t i, const Color& c) {
-        if (i < 300)
-            BaseStrip::setPixel(i + 5 * 300, c);
-        else if (i < 600)
-            BaseStrip::setPixel(7 * 300 - (i - 300) - 1, c);
-    }
+    BaseStrip* strips_[NumStrips];
 };
 
 } // namespace BlinkenAlgorithms
@@ -0,0 +1,391 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/MappedStrip.hpp
+ *
+ * Generic remapper driven by a logical-to-physical index table. Tables are
+ * either generated at compile time or loaded from a layout file.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_MAPPEDSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_MAPPEDSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if !ESP8266 && !TEENSYDUINO
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#endif
+
+namespace BlinkenAlgorithms {
+
+/******************************************************************************/
+// Layout Tables
+
+//! marker for unused entries in a layout table
+static const uint16_t NoPixel = uint16_t(-1);
+
+/*!
+ * Layout table with fixed fan-out: each logical pixel maps to Fanout physical
+ * pixels, unused slots hold NoPixel. Literal type, so tables can be generated
+ * as constexpr and placed into flash on the microcontrollers.
+ */
+template <size_t Size, size_t Fanout = 1>
+struct StripLayout {
+    uint16_t index[Size][Fanout];
+
+    constexpr size_t size() const { return Size; }
+    constexpr size_t fanout() const { return Fanout; }
+
+    const uint16_t* targets(size_t i) const { return index[i]; }
+};
+
+//! logical pixel i is on sub-strip i % NumStrips, sub-strips are concatenated
+template <size_t Size, size_t NumStrips>
+constexpr StripLayout<Size> InterleaveLayout() {
+    static_assert(Size % NumStrips == 0,
+                  "sub-strips must have equal length");
+    static_assert(Size <= NoPixel, "physical index exceeds uint16_t");
+    StripLayout<Size> t {};
+    for (size_t i = 0; i < Size; ++i)
+        t.index[i][0] = (i % NumStrips) * (Size / NumStrips) + i / NumStrips;
+    return t;
+}
+
+//! logical pixel i is physical pixel Size - 1 - i
+template <size_t Size>
+constexpr StripLayout<Size> ReverseLayout() {
+    static_assert(Size <= NoPixel, "physical index exceeds uint16_t");
+    StripLayout<Size> t {};
+    for (size_t i = 0; i < Size; ++i)
+        t.index[i][0] = Size - 1 - i;
+    return t;
+}
+
+//! row-major matrix wired in zig-zag: odd rows run backwards
+template <size_t Rows, size_t Cols>
+constexpr StripLayout<Rows * Cols> SerpentineLayout() {
+    static_assert(Rows * Cols <= NoPixel, "physical index exceeds uint16_t");
+    StripLayout<Rows * Cols> t {};
+    for (size_t r = 0; r < Rows; ++r) {
+        for (size_t c = 0; c < Cols; ++c) {
+            t.index[r * Cols + c][0] =
+                r * Cols + (r % 2 == 0 ? c : Cols - 1 - c);
+        }
+    }
+    return t;
+}
+
+//! each logical pixel covers Repeat adjacent physical pixels
+template <size_t Size, size_t Repeat>
+constexpr StripLayout<Size, Repeat> RepeatLayout() {
+    static_assert(Size * Repeat <= NoPixel, "physical index exceeds uint16_t");
+    StripLayout<Size, Repeat> t {};
+    for (size_t i = 0; i < Size; ++i) {
+        for (size_t r = 0; r < Repeat; ++r)
+            t.index[i][r] = Repeat * i + r;
+    }
+    return t;
+}
+
+//! Milliways Dome: one logical segment of 300 mirrored on five strips
+constexpr StripLayout<300, 5> MultiDomeLayout() {
+    StripLayout<300, 5> t {};
+    for (size_t i = 0; i < 300; ++i) {
+        for (size_t s = 0; s < 5; ++s)
+            t.index[i][s] = s * 300 + i;
+    }
+    return t;
+}
+
+//! Milliways Dome: reversed lower 260 pixels mirrored on five strips
+constexpr StripLayout<260, 5> DomeFFTLayout() {
+    StripLayout<260, 5> t {};
+    for (size_t i = 0; i < 260; ++i) {
+        for (size_t s = 0; s < 5; ++s)
+            t.index[i][s] = s * 300 + 260 - 1 - i;
+    }
+    return t;
+}
+
+//! Milliways Dome: the two bar strips after the five dome strips
+constexpr StripLayout<600> DomeBarLayout() {
+    StripLayout<600> t {};
+    for (size_t i = 0; i < 300; ++i)
+        t.index[i][0] = i + 5 * 300;
+    for (size_t i = 300; i < 600; ++i)
+        t.index[i][0] = 7 * 300 - (i - 300) - 1;
+    return t;
+}
+
+#if !ESP8266 && !TEENSYDUINO
+
+/*!
+ * Layout table built at runtime, e.g. loaded from a layout file. The fan-out
+ * is the maximum number of targets of any logical pixel.
+ */
+class StripLayoutTable
+{
+public:
+    StripLayoutTable() = default;
+
+    //! construct from any compile-time layout
+    template <size_t Size, size_t Fanout>
+    explicit StripLayoutTable(const StripLayout<Size, Fanout>& layout)
+        : index_(&layout.index[0][0], &layout.index[0][0] + Size * Fanout),
+          size_(Size), fanout_(Fanout) { }
+
+    size_t size() const { return size_; }
+    size_t fanout() const { return fanout_; }
+
+    const uint16_t* targets(size_t i) const {
+        return index_.data() + i * fanout_;
+    }
+
+    /*!
+     * Load layout file. Each non-empty line that does not start with '#'
+     * lists the whitespace separated physical indexes of the next logical
+     * pixel.
+     */
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.good()) {
+            std::cerr << "StripLayoutTable: cannot open " << path << std::endl;
+            return false;
+        }
+
+        std::vector<std::vector<uint16_t> > lines;
+        size_t fanout = 0;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t p = line.find_first_not_of(" \t\r");
+            if (p == std::string::npos || line[p] == '#')
+                continue;
+
+            std::istringstream is(line);
+            std::vector<uint16_t> targets;
+            unsigned long x;
+            while (is >> x) {
+                if (x >= NoPixel) {
+                    std::cerr << "StripLayoutTable: index " << x
+                              << " out of range in " << path << std::endl;
+                    return false;
+                }
+                targets.push_back(static_cast<uint16_t>(x));
+            }
+            fanout = std::max(fanout, targets.size());
+            lines.emplace_back(std::move(targets));
+        }
+
+        size_ = lines.size();
+        fanout_ = std::max<size_t>(fanout, 1);
+        index_.assign(size_ * fanout_, NoPixel);
+        for (size_t i = 0; i < size_; ++i) {
+            std::copy(lines[i].begin(), lines[i].end(),
+                      index_.begin() + i * fanout_);
+        }
+        return true;
+    }
+
+private:
+    //! size_ x fanout_ table of physical indexes
+    std::vector<uint16_t> index_;
+
+    //! number of logical pixels
+    size_t size_ = 0;
+
+    //! physical pixels per logical pixel
+    size_t fanout_ = 1;
+};
+
+#endif // !ESP8266 && !TEENSYDUINO
+
+/******************************************************************************/
+// MappedStrip
+
+/*!
+ * Remaps logical pixels via a layout table to the base strip. Each logical
+ * pixel is encoded once into its first target and then copied to the
+ * remaining ones. The layout is copied, hence temporaries like
+ * InterleaveLayout<...>() can be passed.
+ *
+ * If all copies form long runs of consecutive pixels, like the mirrored
+ * segments of the dome, the copies are instead made in bulk with
+ * copyPixels() when the frame is shown.
+ */
+template <typename BaseStrip, typename Layout>
+class MappedStrip : public LEDStripRefBase<BaseStrip>
+{
+public:
+    using Super = LEDStripRefBase<BaseStrip>;
+    using Super::base_;
+
+    MappedStrip(BaseStrip& base, const Layout& layout)
+        : Super(base), layout_(layout) {
+        find_runs();
+    }
+
+    size_t size() const {
+        return layout_.size();
+    }
+
+    void setPixel(size_t i, const Color& c) {
+        if (i >= layout_.size())
+            return;
+        const uint16_t* t = layout_.targets(i);
+        if (t[0] == NoPixel)
+            return;
+        base_.setPixel(t[0], c);
+        replicate(t);
+    }
+
+    //! set all logical pixels to black
+    void clear() {
+        for (size_t i = 0; i < layout_.size(); ++i)
+            setPixel(i, Color(0));
+    }
+
+    void orPixel(size_t i, const Color& c) {
+        if (i >= layout_.size())
+            return;
+        const uint16_t* t = layout_.targets(i);
+        if (t[0] == NoPixel)
+            return;
+        base_.orPixel(t[0], c);
+        replicate(t);
+    }
+
+    void addPixel(size_t i, const Color& c) {
+        if (i >= layout_.size())
+            return;
+        const uint16_t* t = layout_.targets(i);
+        if (t[0] == NoPixel)
+            return;
+        base_.addPixel(t[0], c);
+        replicate(t);
+    }
+
+    //! make the bulk copies, if any, and show the base strip
+    void show() {
+        for (const Run& r : runs_)
+            base_.copyPixels(r.dst, r.src, r.size);
+        base_.show();
+    }
+
+private:
+    Layout layout_;
+
+    //! copyPixels(dst, src, size) replicating a run of pixels
+    struct Run {
+        uint16_t dst, src, size;
+    };
+
+    //! bulk copies, empty if the copies are made per pixel
+    std::vector<Run> runs_;
+
+    //! shortest run worth a bulk copy
+    static const size_t min_run_ = 16;
+
+    //! copy encoded first target to the other targets
+    void replicate(const uint16_t* t) {
+        if (!runs_.empty())
+            return;
+        for (size_t k = 1; k < layout_.fanout(); ++k) {
+            if (t[k] != NoPixel)
+                base_.copyPixel(t[k], t[0]);
+        }
+    }
+
+    //! Split the copies into runs of consecutive pixels, ascending or
+    //! descending, and keep them only if all runs are long.
+    void find_runs() {
+        for (size_t k = 1; k < layout_.fanout(); ++k) {
+            for (size_t i = 0; i < layout_.size(); ++i) {
+                const uint16_t* t = layout_.targets(i);
+                if (t[0] == NoPixel || t[k] == NoPixel)
+                    continue;
+                if (i != 0 && !runs_.empty() && extend(runs_.back(),
+                                                       layout_.targets(i - 1),
+                                                       t, k))
+                    continue;
+                runs_.push_back(Run { t[k], t[0], 1 });
+            }
+        }
+        for (const Run& r : runs_) {
+            if (r.size < min_run_) {
+                runs_.clear();
+                break;
+            }
+        }
+    }
+
+    //! extend run r by target k of t if the previous pixel p ends it
+    static bool extend(Run& r, const uint16_t* p, const uint16_t* t,
+                       size_t k) {
+        if (p[0] == r.src + r.size - 1 && p[k] == r.dst + r.size - 1 &&
+            t[0] == p[0] + 1 && t[k] == p[k] + 1) {
+            ++r.size;
+            return true;
+        }
+        if (p[0] == r.src && p[k] == r.dst &&
+            t[0] + 1 == p[0] && t[k] + 1 == p[k]) {
+            r.src = t[0], r.dst = t[k], ++r.size;
+            return true;
+        }
+        return false;
+    }
+};
+
+/******************************************************************************/
+// Milliways Dome @ EMF 2018
+
+//! one logical segment of 300 mirrored on five strips
+template <typename BaseStrip>
+class LEDMultiDomeStrip : public MappedStrip<BaseStrip, StripLayout<300, 5> >
+{
+public:
+    using Super = MappedStrip<BaseStrip, StripLayout<300, 5> >;
+
+    LEDMultiDomeStrip(BaseStrip& base)
+        : Super(base, MultiDomeLayout()) { }
+};
+
+//! reversed lower 260 pixels mirrored on five strips
+template <typename BaseStrip>
+class LEDDomeFFTStrip : public MappedStrip<BaseStrip, StripLayout<260, 5> >
+{
+public:
+    using Super = MappedStrip<BaseStrip, StripLayout<260, 5> >;
+
+    LEDDomeFFTStrip(BaseStrip& base)
+        : Super(base, DomeFFTLayout()) { }
+};
+
+//! the two bar strips after the five dome strips
+template <typename BaseStrip>
+class LEDDomeBarStrip : public MappedStrip<BaseStrip, StripLayout<600> >
+{
+public:
+    using Super = MappedStrip<BaseStrip, StripLayout<600> >;
+
+    LEDDomeBarStrip(BaseStrip& base)
+        : Super(base, DomeBarLayout()) { }
+};
+
+/******************************************************************************/
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_MAPPEDSTRIP_HEADER
+
+/******************************************************************************/
@@ -13,21 +13,42 @@
 
 #include <NeoPixelBus.h>
 
+#include <vector>
+
 namespace BlinkenAlgorithms {
 
-template <typename NeoPixelBus>
+/*!
+ * Adapter for NeoPixelBus strips. With ShadowBuffer the adapter keeps an
+ * unpacked copy of the colors before gamma correction: orPixel() and
+ * addPixel() then never read back from the driver, and gamma and driver
+ * encoding are done once per pixel in show().
+ */
+template <typename NeoPixelBus, bool ShadowBuffer = false>
 class NeoPixelBusAdapter : public LEDStripBase
 {
 public:
     explicit NeoPixelBusAdapter(NeoPixelBus& strip)
-        : LEDStripBase(), strip_(strip) { }
+        : LEDStripBase(), strip_(strip) {
+        if (ShadowBuffer)
+            shadow_.resize(strip_.PixelCount(), Color(0));
+    }
 
     size_t size() const {
         return strip_.PixelCount();
     }
 
-    void show() const {
-        return strip_.Show();
+    //! show frame, skipped if no pixel changed
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+        if (ShadowBuffer) {
+            for (size_t i = 0; i < shadow_.size(); ++i)
+                setPixelRaw(i, gamma(shadow_[i]));
+        }
+        strip_.Show();
+        clear_dirty();
     }
 
     bool busy() {
@@ -35,8 +56,9 @@ public:
     }
 
     void setPixel(size_t i, const Color& c) {
-        setPixelRaw(i, Color(gamma8(c.r), gamma8(c.g),
-                             gamma8(c.b), gamma8(c.w)));
+        if (ShadowBuffer)
+            return storeShadow(i, c);
+        storeRaw(i, gamma(c));
     }
 
     Color getPixel(size_t i) const {
@@ -44,22 +66,100 @@ public:
         return Color(c.R, c.G, c.B, c.W);
     }
 
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            setPixel(first + i, colors[i]);
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        static_assert(!ShadowBuffer,
+                      "the shadow buffer holds colors before gamma correction");
+        for (size_t i = 0; i < n; ++i)
+            storeRaw(first + i, colors[i]);
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < size(); ++i) {
+            if (ShadowBuffer)
+                storeShadow(i, Color(0));
+            else
+                storeRaw(i, Color(0));
+        }
+    }
+
     void orPixel(size_t i, const Color& c) {
+        if (ShadowBuffer) {
+            if (i < shadow_.size())
+                storeShadow(i, shadow_[i] | c);
+            return;
+        }
         Color c1 = getPixel(i);
-        Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
-        return setPixelRaw(i, c1 | c2);
+        storeRaw(i, c1 | gamma(c));
     }
 
     void addPixel(size_t i, const Color& c) {
+        if (ShadowBuffer) {
+            if (i < shadow_.size())
+                storeShadow(i, shadow_[i] + c);
+            return;
+        }
         Color c1 = getPixel(i);
-        Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
-        return setPixelRaw(i, c1 + c2);
+        storeRaw(i, c1 + gamma(c));
+    }
+
+    //! copy a pixel without gamma correcting or encoding it again
+    void copyPixel(size_t dst, size_t src) {
+        if (ShadowBuffer) {
+            if (src < shadow_.size())
+                storeShadow(dst, shadow_[src]);
+            return;
+        }
+        if (src < size())
+            storeRaw(dst, getPixel(src));
+    }
+
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst <= src) {
+            for (size_t i = 0; i < n; ++i)
+                copyPixel(dst + i, src + i);
+        }
+        else {
+            for (size_t i = n; i != 0; --i)
+                copyPixel(dst + i - 1, src + i - 1);
+        }
     }
 
 private:
     NeoPixelBus& strip_;
 
-    void setPixelRaw(size_t i, const Color& c) {
+    //! colors before gamma correction, only used with ShadowBuffer
+    std::vector<Color> shadow_;
+
+    Color gamma(const Color& c) const {
+        return Color(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
+    }
+
+    //! store color before gamma correction, marking it dirty if it changed
+    void storeShadow(size_t i, const Color& c) {
+        if (i < shadow_.size() && shadow_[i].v != c.v) {
+            shadow_[i] = c;
+            mark_dirty(i);
+        }
+    }
+
+    //! store gamma corrected color and mark it dirty, without reading the
+    //! driver back to compare, which would cost a driver call per write
+    void storeRaw(size_t i, const Color& c) {
+        if (i < size()) {
+            setPixelRaw(i, c);
+            mark_dirty(i);
+        }
+    }
+
+    void setPixelRaw(size_t i, const Color& c) const {
         strip_.SetPixelColor(i, RgbwColor(c.r, c.g, c.b, c.w));
     }
 };
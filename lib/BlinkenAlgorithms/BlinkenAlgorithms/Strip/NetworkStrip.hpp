@@ -0,0 +1,275 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/NetworkStrip.hpp
+ *
+ * Strip which sends its frames via DDP over UDP to a remote pixel controller,
+ * e.g. an ESP8266 or a Pi running pixel-receiver.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_NETWORKSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_NETWORKSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Extra/DDP.hpp>
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+#include <BlinkenAlgorithms/Strip/PixelFormat.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Format is the pixel's wire format, DDP carries PixelFormatRGB or
+ * PixelFormatRGBW pixels.
+ */
+template <typename Format = PixelFormatRGB>
+class NetworkStrip : public LEDStripBase
+{
+    static_assert(Format::is_rgb, "DDP pixels are in RGB(W) order");
+
+public:
+    //! Send to host (IPv4 address) and port. If changes_only is set, show()
+    //! sends only the range of changed pixels and skips unchanged frames,
+    //! which assumes the receiver keeps pixels between frames and no packets
+    //! are lost.
+    NetworkStrip(const std::string& host, size_t strip_size,
+                 uint16_t port = DDP::port, bool changes_only = false)
+        : strip_size_(strip_size),
+          changes_only_(changes_only),
+          colors_(strip_size, Color(0)),
+          wire_(strip_size * bpp_, 0) {
+
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (fd_ < 0 || inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+            connect(fd_, reinterpret_cast<struct sockaddr*>(&addr),
+                    sizeof(addr)) < 0) {
+            std::cerr << "NetworkStrip " << host << ":" << port
+                      << " failed: " << strerror(errno) << std::endl;
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+
+        int sndbuf = 1 << 20;
+        setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+        // packets never split a pixel: max_data is a multiple of 3 and 4
+        size_t packets = (wire_.size() + DDP::max_data - 1) / DDP::max_data;
+        headers_.resize(std::max<size_t>(packets, 1) * DDP::header_size);
+        iovs_.resize(2 * std::max<size_t>(packets, 1));
+        msgs_.resize(std::max<size_t>(packets, 1));
+    }
+
+    //! non-copyable: owns the socket
+    NetworkStrip(const NetworkStrip&) = delete;
+    NetworkStrip& operator = (const NetworkStrip&) = delete;
+
+    ~NetworkStrip() {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    size_t size() const { return strip_size_; }
+
+    void setPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, gamma(color));
+    }
+
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        if (first >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - first);
+        for (size_t i = 0; i < n; ++i)
+            store(first + i, gamma(colors[i]));
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        if (first >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - first);
+        for (size_t i = 0; i < n; ++i)
+            store(first + i, colors[i]);
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < strip_size_; ++i)
+            store(i, Color(0));
+    }
+
+    //! gamma corrected color of a pixel
+    Color getPixel(size_t index) const {
+        return index < strip_size_ ? colors_[index] : Color(0);
+    }
+
+    void orPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, colors_[index] | gamma(color));
+    }
+
+    void addPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, colors_[index] + gamma(color));
+    }
+
+    //! copy a pixel without gamma correcting it again
+    void copyPixel(size_t dst, size_t src) {
+        if (dst < strip_size_ && src < strip_size_)
+            store(dst, colors_[src]);
+    }
+
+    //! copy a run of pixels, ranges may overlap
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= strip_size_ || src >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - std::max(dst, src));
+        if (memcmp(&colors_[dst], &colors_[src], n * sizeof(Color)) == 0)
+            return;
+        memmove(&colors_[dst], &colors_[src], n * sizeof(Color));
+        memmove(&wire_[dst * bpp_], &wire_[src * bpp_], n * bpp_);
+        mark_dirty(dst, dst + n);
+    }
+
+    bool busy() const { return false; }
+
+    //! Send the frame, or its changed range, as DDP packets of up to max_data
+    //! bytes with a single sendmmsg() call. The payload is referenced from
+    //! the wire buffer, not copied.
+    void show() {
+        if (fd_ < 0)
+            return;
+
+        size_t begin = 0, end = strip_size_;
+        if (changes_only_) {
+            if (!dirty()) {
+                ++skipped_frames_;
+                return;
+            }
+            begin = dirty_begin_;
+            end = std::min(dirty_end_, strip_size_);
+        }
+        clear_dirty();
+
+        // no pixels to send, e.g. an empty strip: do not push an empty frame
+        if (begin >= end) {
+            ++skipped_frames_;
+            return;
+        }
+
+        size_t off = begin * bpp_, wire_end = end * bpp_;
+        size_t count = 0;
+        do {
+            size_t n = std::min(size_t(DDP::max_data), wire_end - off);
+            uint8_t* hdr = &headers_[count * DDP::header_size];
+            seq_ = DDP::next_seq(seq_);
+            DDP::write_header(
+                hdr, off + n == wire_end ? DDP::flag_push : 0, seq_,
+                Format::has_white ? uint8_t(DDP::type_rgbw8)
+                : uint8_t(DDP::type_rgb8),
+                DDP::id_display, off, n);
+
+            struct iovec* iov = &iovs_[2 * count];
+            iov[0].iov_base = hdr;
+            iov[0].iov_len = DDP::header_size;
+            iov[1].iov_base = wire_.data() + off;
+            iov[1].iov_len = n;
+
+            struct msghdr& h = msgs_[count].msg_hdr;
+            memset(&h, 0, sizeof(h));
+            h.msg_iov = iov;
+            h.msg_iovlen = 2;
+
+            off += n, ++count;
+        } while (off < wire_end);
+
+        for (size_t sent = 0; sent < count; ) {
+            int r = sendmmsg(fd_, &msgs_[sent], count - sent, 0);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                // ECONNREFUSED from a missing receiver, drop the frame
+                ++send_errors_;
+                break;
+            }
+            sent += r;
+        }
+        packets_ += count;
+    }
+
+    //! number of DDP packets sent
+    size_t packets() const { return packets_; }
+
+    //! number of frames which could not be sent completely
+    size_t send_errors() const { return send_errors_; }
+
+private:
+    //! bytes per pixel
+    static const size_t bpp_ = Format::bytes;
+
+    //! strip length
+    size_t strip_size_;
+
+    //! send only changed ranges
+    bool changes_only_;
+
+    //! connected UDP socket
+    int fd_ = -1;
+
+    //! gamma corrected colors, used to detect changes and to read back
+    std::vector<Color> colors_;
+
+    //! RGB(W) payload of the whole strip
+    std::vector<uint8_t> wire_;
+
+    //! DDP headers, iovecs and messages of one frame
+    std::vector<uint8_t> headers_;
+    std::vector<struct iovec> iovs_;
+    std::vector<struct mmsghdr> msgs_;
+
+    //! last DDP sequence number
+    uint8_t seq_ = 0;
+
+    size_t packets_ = 0;
+    size_t send_errors_ = 0;
+
+    Color gamma(const Color& c) const {
+        return Color(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
+    }
+
+    //! store gamma corrected color, marking it if it changed
+    void store(size_t index, const Color& c) {
+        if (colors_[index].v == c.v)
+            return;
+        colors_[index] = c;
+        Format::encode(&wire_[index * bpp_], c);
+        mark_dirty(index);
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_NETWORKSTRIP_HEADER
+
+/******************************************************************************/
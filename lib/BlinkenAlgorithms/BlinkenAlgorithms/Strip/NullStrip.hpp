@@ -0,0 +1,49 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/NullStrip.hpp
+ *
+ * Strip without any output, for running animations on a host for profiling
+ * and benchmarks.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_NULLSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_NULLSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Framebuffer whose show() only counts frames: pixels are stored and can be
+ * read back, but no I/O happens.
+ */
+class NullStrip : public Framebuffer
+{
+public:
+    explicit NullStrip(size_t strip_size)
+        : Framebuffer(strip_size) { }
+
+    void show() {
+        ++shows_;
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        setPixels(first, colors, n);
+    }
+
+    //! number of show() calls
+    size_t shows() const { return shows_; }
+
+private:
+    size_t shows_ = 0;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_NULLSTRIP_HEADER
+
+/******************************************************************************/
@@ -31,21 +31,42 @@
 
 #include <OctoSK6812.h>
 
+#include <vector>
+
 namespace BlinkenAlgorithms {
 
-template <typename OctoSK6812>
+/*!
+ * Adapter for OctoSK6812 strips. With ShadowBuffer the adapter keeps an
+ * unpacked copy of the colors before gamma correction: orPixel() and
+ * addPixel() then never read back from the driver, and gamma and driver
+ * encoding are done once per pixel in show().
+ */
+template <typename OctoSK6812, bool ShadowBuffer = false>
 class OctoSK6812Adapter : public LEDStripBase
 {
 public:
     explicit OctoSK6812Adapter(OctoSK6812& strip, size_t active_parts = 8)
-        : LEDStripBase(), strip_(strip), active_parts_(active_parts) { }
+        : LEDStripBase(), strip_(strip), active_parts_(active_parts) {
+        if (ShadowBuffer)
+            shadow_.resize(size(), Color(0));
+    }
 
     size_t size() const {
         return strip_.numPixels() * active_parts_ / 8;
     }
 
-    void show() const {
-        return strip_.show();
+    //! show frame, skipped if no pixel changed
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+        if (ShadowBuffer) {
+            for (size_t i = 0; i < shadow_.size(); ++i)
+                setPixelRaw(i, gamma(shadow_[i]));
+        }
+        strip_.show();
+        clear_dirty();
     }
 
     bool busy() {
@@ -53,24 +74,79 @@ public:
     }
 
     void setPixel(size_t i, const Color& c) {
-        Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
-        setPixelRaw(i, c2);
+        if (ShadowBuffer)
+            return storeShadow(i, c);
+        storeRaw(i, gamma(c));
     }
 
     Color getPixel(size_t i) const {
         return ColorRGBW(strip_.getPixel(i));
     }
 
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            setPixel(first + i, colors[i]);
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        static_assert(!ShadowBuffer,
+                      "the shadow buffer holds colors before gamma correction");
+        for (size_t i = 0; i < n; ++i)
+            storeRaw(first + i, colors[i]);
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < size(); ++i) {
+            if (ShadowBuffer)
+                storeShadow(i, Color(0));
+            else
+                storeRaw(i, Color(0));
+        }
+    }
+
     void orPixel(size_t i, const Color& c) {
+        if (ShadowBuffer) {
+            if (i < shadow_.size())
+                storeShadow(i, shadow_[i] | c);
+            return;
+        }
         Color c1 = strip_.getPixel(i);
-        Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
-        setPixelRaw(i, c1 | c2);
+        storeRaw(i, c1 | gamma(c));
     }
 
     void addPixel(size_t i, const Color& c) {
+        if (ShadowBuffer) {
+            if (i < shadow_.size())
+                storeShadow(i, shadow_[i] + c);
+            return;
+        }
         Color c1 = strip_.getPixel(i);
-        Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
-        setPixelRaw(i, c1 + c2);
+        storeRaw(i, c1 + gamma(c));
+    }
+
+    //! copy a pixel without gamma correcting or encoding it again
+    void copyPixel(size_t dst, size_t src) {
+        if (ShadowBuffer) {
+            if (src < shadow_.size())
+                storeShadow(dst, shadow_[src]);
+            return;
+        }
+        if (src < size())
+            storeRaw(dst, Color::ColorWBGR(strip_.getPixel(src)));
+    }
+
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst <= src) {
+            for (size_t i = 0; i < n; ++i)
+                copyPixel(dst + i, src + i);
+        }
+        else {
+            for (size_t i = n; i != 0; --i)
+                copyPixel(dst + i - 1, src + i - 1);
+        }
     }
 
 private:
@@ -78,7 +154,31 @@ private:
 
     size_t active_parts_;
 
-    void setPixelRaw(size_t i, const Color& c) {
+    //! colors before gamma correction, only used with ShadowBuffer
+    std::vector<Color> shadow_;
+
+    Color gamma(const Color& c) const {
+        return Color(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
+    }
+
+    //! store color before gamma correction, marking it dirty if it changed
+    void storeShadow(size_t i, const Color& c) {
+        if (i < shadow_.size() && shadow_[i].v != c.v) {
+            shadow_[i] = c;
+            mark_dirty(i);
+        }
+    }
+
+    //! store gamma corrected color and mark it dirty, without reading the
+    //! driver back to compare, which would cost a driver call per write
+    void storeRaw(size_t i, const Color& c) {
+        if (i < size()) {
+            setPixelRaw(i, c);
+            mark_dirty(i);
+        }
+    }
+
+    void setPixelRaw(size_t i, const Color& c) const {
         strip_.setPixel(i, c.v);
     }
 };
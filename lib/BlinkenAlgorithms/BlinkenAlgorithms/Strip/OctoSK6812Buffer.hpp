@@ -59,11 +59,20 @@ public:
         return active_size_;
     }
 
-    void show() const {
-        for (size_t i = 0; i < active_size_; ++i) {
+    //! show frame, skipped if no pixel changed
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+        // the library keeps its drawing buffer, hence only re-encode the
+        // changed range into it
+        size_t end = std::min(dirty_end_, active_size_);
+        for (size_t i = dirty_begin_; i < end; ++i) {
             strip_.setPixel(i, buffer_[i].v);
         }
-        return strip_.show();
+        strip_.show();
+        clear_dirty();
     }
 
     bool busy() {
@@ -79,6 +88,24 @@ public:
         return i < active_size_ ? buffer_[i] : Color(0);
     }
 
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            setPixel(first + i, colors[i]);
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            setPixelRaw(first + i, colors[i]);
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < active_size_; ++i)
+            setPixelRaw(i, Color(0));
+    }
+
     void orPixel(size_t i, const Color& c) {
         Color c1 = getPixel(i);
         Color c2(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
@@ -91,6 +118,22 @@ public:
         setPixelRaw(i, c1 + c2);
     }
 
+    //! copy a pixel without gamma correcting it again
+    void copyPixel(size_t dst, size_t src) {
+        if (src < active_size_)
+            setPixelRaw(dst, buffer_[src]);
+    }
+
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= active_size_ || src >= active_size_)
+            return;
+        n = std::min(n, active_size_ - std::max(dst, src));
+        if (memcmp(buffer_ + dst, buffer_ + src, n * sizeof(Color)) == 0)
+            return;
+        memmove(buffer_ + dst, buffer_ + src, n * sizeof(Color));
+        mark_dirty(dst, dst + n);
+    }
+
 private:
     OctoSK6812& strip_;
 
@@ -100,9 +143,12 @@ private:
 
     Color* buffer_;
 
+    //! store gamma corrected color, marking it dirty if it changed
     void setPixelRaw(size_t i, const Color& c) {
-        if (i < active_size_)
+        if (i < active_size_ && buffer_[i].v != c.v) {
             buffer_[i] = c;
+            mark_dirty(i);
+        }
     }
 };
 
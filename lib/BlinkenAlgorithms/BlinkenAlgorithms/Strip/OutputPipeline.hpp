@@ -0,0 +1,196 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/OutputPipeline.hpp
+ *
+ * Output stage between framebuffer and driver: brightness, per-channel white
+ * balance, gamma correction and channel order fused into one lookup table per
+ * output channel.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_OUTPUTPIPELINE_HEADER
+#define BLINKENALGORITHMS_STRIP_OUTPUTPIPELINE_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace BlinkenAlgorithms {
+
+class OutputPipeline
+{
+public:
+    OutputPipeline() {
+        set_channel_order("RGBW");
+    }
+
+    //! global brightness, 255 = full
+    uint8_t brightness() const { return brightness_; }
+
+    void set_brightness(uint8_t brightness) {
+        brightness_ = brightness;
+        valid_ = false;
+    }
+
+    //! per-channel white balance, 255 = full
+    void set_white_balance(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 255) {
+        balance_[ch_r] = r, balance_[ch_g] = g;
+        balance_[ch_b] = b, balance_[ch_w] = w;
+        valid_ = false;
+    }
+
+    //! enable or disable gamma correction with LEDStripBase::gamma8_table()
+    void set_gamma(bool enable) {
+        gamma_ = enable;
+        valid_ = false;
+    }
+
+    //! Set input channels feeding the output's R, G, B and W channels, e.g.
+    //! "GRBW" for a strip which has red and green swapped. Returns false on an
+    //! invalid order string.
+    bool set_channel_order(const char* order) {
+        uint8_t source[4];
+        for (size_t i = 0; i < 4; ++i) {
+            switch (order[i]) {
+            case 'R': source[i] = ch_r; break;
+            case 'G': source[i] = ch_g; break;
+            case 'B': source[i] = ch_b; break;
+            case 'W': source[i] = ch_w; break;
+            default: return false;
+            }
+        }
+        std::copy(source, source + 4, source_);
+        valid_ = false;
+        return true;
+    }
+
+    //! Transform n colors from src to dst. The table lookups are a gather,
+    //! which SSE2 and NEON cannot vectorize, hence the loop is kept simple.
+    void apply(Color* dst, const Color* src, size_t n) {
+        if (!valid_)
+            rebuild();
+
+        const uint8_t* lr = lut_[ch_r];
+        const uint8_t* lg = lut_[ch_g];
+        const uint8_t* lb = lut_[ch_b];
+        const uint8_t* lw = lut_[ch_w];
+        const uint8_t sr = source_[0], sg = source_[1];
+        const uint8_t sb = source_[2], sw = source_[3];
+
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* in = reinterpret_cast<const uint8_t*>(src + i);
+            Color c;
+            c.r = lr[in[sr]];
+            c.g = lg[in[sg]];
+            c.b = lb[in[sb]];
+            c.w = lw[in[sw]];
+            dst[i] = c;
+        }
+    }
+
+private:
+    //! byte offsets of the channels in Color
+    static const uint8_t ch_w = 0, ch_b = 1, ch_g = 2, ch_r = 3;
+
+    uint8_t brightness_ = 255;
+    uint8_t balance_[4] = { 255, 255, 255, 255 };
+    bool gamma_ = true;
+
+    //! input byte offset for output R, G, B, W
+    uint8_t source_[4];
+
+    //! fused lookup table per output channel, indexed by byte offset
+    uint8_t lut_[4][256];
+
+    //! whether lut_ matches the settings
+    bool valid_ = false;
+
+    void rebuild() {
+        const uint8_t* gamma = gamma_ ? LEDStripBase::gamma8_table()
+                               : LEDStripBase::linear8_table();
+        for (size_t ch = 0; ch < 4; ++ch) {
+            uint32_t f = uint32_t(brightness_) * balance_[ch];
+            for (unsigned v = 0; v < 256; ++v)
+                lut_[ch][v] = gamma[(v * f + 255 * 255 / 2) / (255 * 255)];
+        }
+        valid_ = true;
+    }
+};
+
+/*!
+ * Framebuffer in front of a strip with an OutputPipeline. Animations render
+ * at full intensity: intensity() reports 255, and set_intensity() sets the
+ * pipeline's brightness instead. show() transforms the frame and hands it to
+ * the strip's setPixelsRaw(). Strips with begin_frame(), like PiSPI_APA102,
+ * instead receive it encoded straight into their wire buffer with
+ * encodeRaw(), which skips the per-pixel change detection and sends every
+ * frame.
+ */
+template <typename BaseStrip>
+class PipelineStrip : public Framebuffer
+{
+public:
+    explicit PipelineStrip(BaseStrip& base)
+        : Framebuffer(base.size()), base_(base), output_(base.size()) {
+        pipeline_.set_brightness(base.intensity());
+    }
+
+    void show() {
+        pipeline_.apply(output_.data(), data(), size());
+        send(base_, output_.data(), size(), 0);
+    }
+
+    bool busy() const {
+        return base_.busy();
+    }
+
+    uint8_t intensity() const {
+        return 255;
+    }
+    void set_intensity(uint8_t intensity) {
+        pipeline_.set_brightness(intensity);
+    }
+
+    size_t skipped_frames() const {
+        return base_.skipped_frames();
+    }
+
+    OutputPipeline& pipeline() { return pipeline_; }
+
+    BaseStrip& base() { return base_; }
+
+private:
+    BaseStrip& base_;
+
+    OutputPipeline pipeline_;
+
+    //! transformed frame
+    std::vector<Color> output_;
+
+    //! zero-copy path, chosen by overload resolution if begin_frame() exists
+    template <typename Strip>
+    static auto send(Strip& strip, const Color* colors, size_t n, int)
+    -> decltype(strip.begin_frame(), void()) {
+        auto frame = strip.begin_frame();
+        Strip::encodeRaw(frame.data(), colors, std::min(n, frame.size()));
+        strip.end_frame();
+    }
+
+    template <typename Strip>
+    static void send(Strip& strip, const Color* colors, size_t n, long) {
+        strip.setPixelsRaw(0, colors, n);
+        strip.show();
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_OUTPUTPIPELINE_HEADER
+
+/******************************************************************************/
@@ -10,178 +10,306 @@
 #define BLINKENALGORITHMS_STRIP_PISPI_APA102_HEADER
 
 #include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Extra/OutputThread.hpp>
 #include <BlinkenAlgorithms/Extra/PiGPIO.hpp>
+#include <BlinkenAlgorithms/Extra/PiSPI.hpp>
+#include <BlinkenAlgorithms/Strip/APA102Encoder.hpp>
 #include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+#include <BlinkenAlgorithms/Strip/WireView.hpp>
 
-#include <cerrno>
+#include <algorithm>
+#include <cassert>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <vector>
 
-#include <asm/ioctl.h>
-#include <linux/spi/spidev.h>
-#include <sys/ioctl.h>
-
 namespace BlinkenAlgorithms {
 
+/*!
+ * APA102 strip on a spidev device. Format is the wire format, a
+ * PixelFormatAPA102 with the strip's color order.
+ */
+template <typename Format = PixelFormatAPA102<> >
 class PiSPI_APA102 : public LEDStripBase
 {
 public:
-    PiSPI_APA102(std::string path, size_t strip_size, int cs_pin = -1)
+    //! Open SPI strip. If async is set, show() only hands the frame to a
+    //! dedicated transmit thread and busy() reports the transfer in flight.
+    PiSPI_APA102(std::string path, size_t strip_size, int cs_pin = -1,
+                 bool async = false)
         : strip_size_(strip_size),
-          strip_data_(strip_size) {
+          strip_data_(strip_size),
+          end_frame_((strip_size / 2 + 7) / 8, 0xFF),
+          partial_end_frame_(end_frame_.size(), 0x00) {
 
-        fd_ = open(path.c_str(), O_RDWR);
-        if (fd_ < 0) {
+        if (!spi_.open(path, /* speed_hz */ 13000000)) {
             std::cerr << "PiSPI_APA102 failed" << std::endl;
             return;
         }
 
-        int mode = 3;
-        if (ioctl(fd_, SPI_IOC_WR_MODE, &mode) < 0) {
-            std::cerr << "SPI Mode Change failure: "
-                      << strerror(errno) << std::endl;
-        }
+        cs_gpio_.set_pin(cs_pin, /* output */ true);
+        cs_gpio_.write(0);
 
-        int spiBPW = 8;
-        if (ioctl(fd_, SPI_IOC_WR_BITS_PER_WORD, &spiBPW) < 0) {
-            std::cerr << "SPI BPW Change failure: "
-                      << strerror(errno) << std::endl;
+        if (async) {
+            tx_data_.resize(strip_size_);
+            tx_thread_.reset(new OutputThread(
+                [this]() { transmit(tx_data_.data(), tx_count_); }));
         }
+    }
 
-        spiSpeed_ = 13000000;
-        if (ioctl(fd_, SPI_IOC_WR_MAX_SPEED_HZ, &spiSpeed_) < 0) {
-            std::cerr << "SPI Speed Change failure: "
-                      << strerror(errno) << std::endl;
-        }
+    using APAColor = BlinkenAlgorithms::APAColor;
 
-        cs_gpio_.set_pin(cs_pin, /* output */ true);
-        cs_gpio_.write(0);
+    //! gamma correct and encode color into APA102 wire format
+    APAColor encodeColor(const Color& color) const {
+        return APA102Encoder::encode<Format>(color, gamma8_table());
     }
 
-    struct APAColor {
-        uint8_t w = 0, b = 0, g = 0, r = 0;
-    };
+    //! encode n already gamma corrected colors, e.g. into begin_frame()
+    static void encodeRaw(APAColor* dst, const Color* src, size_t n) {
+        APA102Encoder::encode<Format>(dst, src, n, linear8_table());
+    }
 
     void setPixel(size_t index, const Color& color) {
         if (index < strip_size_) {
-            // combine RGBW to RGB
-            unsigned r = gamma8(color.r), g = gamma8(color.g), b = gamma8(color.b);
-            r += gamma8(color.w), g += gamma8(color.w), b += gamma8(color.w);
-            // try to transform color to RGB + brightness
-            const uint16_t mm = 0x1F;
-            unsigned m = (((std::max(std::max(r, g), b) + 1) * mm - 1) >> 8) + 1;
-            r = (mm * r + (m >> 1)) / m;
-            g = (mm * g + (m >> 1)) / m;
-            b = (mm * b + (m >> 1)) / m;
-            r = r > 255 ? 255 : r, g = g > 255 ? 255 : g;
-            b = b > 255 ? 255 : b, m = m > 31 ? 31 : m;
-            strip_data_[index].r = r;
-            strip_data_[index].g = g;
-            strip_data_[index].b = b;
-            strip_data_[index].w = 0b11100000 | (0b00011111 & m);
+            store(index, encodeColor(color));
         }
     }
 
+    //! set a run of pixels starting at first, encoding them in batches
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        setPixels(first, colors, n, gamma8_table());
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        setPixels(first, colors, n, linear8_table());
+    }
+
+    //! set all pixels to black
+    void clear() {
+        APAColor black = encodeColor(Color(0));
+        for (size_t i = 0; i < strip_size_; ++i)
+            store(i, black);
+    }
+
     void orPixel(size_t index, const Color& color) {
         if (index < strip_size_) {
-            // combine RGBW to RGB
-            unsigned r = gamma8(color.r), g = gamma8(color.g), b = gamma8(color.b);
-            r += gamma8(color.w), g += gamma8(color.w), b += gamma8(color.w);
-            // try to transform color to RGB + brightness
-            const uint16_t mm = 0x1F;
-            unsigned m = (((std::max(std::max(r, g), b) + 1) * mm - 1) >> 8) + 1;
-            r = (mm * r + (m >> 1)) / m;
-            g = (mm * g + (m >> 1)) / m;
-            b = (mm * b + (m >> 1)) / m;
-            r = r > 255 ? 255 : r, g = g > 255 ? 255 : g;
-            b = b > 255 ? 255 : b, m = m > 31 ? 31 : m;
-            strip_data_[index].r |= r;
-            strip_data_[index].g |= g;
-            strip_data_[index].b |= b;
-            strip_data_[index].w |= 0b11100000 | (0b00011111 & m);
+            sync_back();
+            APAColor c = encodeColor(color), p = strip_data_[index];
+            p.r |= c.r;
+            p.g |= c.g;
+            p.b |= c.b;
+            p.w |= c.w;
+            store(index, p);
         }
     }
 
     void addPixel(size_t index, const Color& color) {
         if (index < strip_size_) {
-            // combine RGBW to RGB
-            unsigned r = gamma8(color.r), g = gamma8(color.g), b = gamma8(color.b);
-            r += gamma8(color.w), g += gamma8(color.w), b += gamma8(color.w);
-            // try to transform color to RGB + brightness
-            const uint16_t mm = 0x1F;
-            unsigned m = (((std::max(std::max(r, g), b) + 1) * mm - 1) >> 8) + 1;
-            r = (mm * r + (m >> 1)) / m;
-            g = (mm * g + (m >> 1)) / m;
-            b = (mm * b + (m >> 1)) / m;
-            r = r > 255 ? 255 : r, g = g > 255 ? 255 : g;
-            b = b > 255 ? 255 : b, m = m > 31 ? 31 : m;
-            strip_data_[index].r =
-                std::min(255, static_cast<uint16_t>(r) + strip_data_[index].r);
-            strip_data_[index].g =
-                std::min(255, static_cast<uint16_t>(g) + strip_data_[index].g);
-            strip_data_[index].b =
-                std::min(255, static_cast<uint16_t>(b) + strip_data_[index].b);
-            strip_data_[index].w =
-                0b11100000 | std::min(
-                    31u, (0b00011111 & m) + (0b00011111 & strip_data_[index].w));
+            sync_back();
+            APAColor c = encodeColor(color), p = strip_data_[index];
+            p.r = std::min(255, static_cast<uint16_t>(c.r) + p.r);
+            p.g = std::min(255, static_cast<uint16_t>(c.g) + p.g);
+            p.b = std::min(255, static_cast<uint16_t>(c.b) + p.b);
+            p.w = 0b11100000 | std::min(
+                31, (0b00011111 & c.w) + (0b00011111 & p.w));
+            store(index, p);
+        }
+    }
+
+    //! copy already encoded pixels, e.g. to mirror a segment
+    void copyPixel(size_t dst, size_t src) {
+        if (dst < strip_size_ && src < strip_size_) {
+            sync_back();
+            store(dst, strip_data_[src]);
         }
     }
 
-    bool busy() const { return false; }
+    //! copy a run of already encoded pixels, ranges may overlap
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= strip_size_ || src >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - std::max(dst, src));
+        sync_back();
+        if (memcmp(&strip_data_[dst], &strip_data_[src],
+                   n * sizeof(APAColor)) == 0)
+            return;
+        memmove(&strip_data_[dst], &strip_data_[src], n * sizeof(APAColor));
+        mark_dirty(dst, dst + n);
+    }
 
-    void show() {
-        uint8_t buf_start[4] = { 0x00, 0x00, 0x00, 0x00 };
-        SPIwrite(buf_start, 4);
+    //! read encoded pixel data
+    const APAColor& wirePixel(size_t index) const {
+        return back_stale_ ? tx_data_[index] : strip_data_[index];
+    }
 
-        SPIwrite(reinterpret_cast<uint8_t*>(strip_data_.data()),
-                 4 * strip_size_);
+    //! write encoded pixel data
+    void setWirePixel(size_t index, const APAColor& c) {
+        if (index < strip_size_)
+            store(index, c);
+    }
 
-        buf_start[0] = 0xFF;
-        for (size_t i = 0; i < (strip_size_ / 2 + 7) / 8; ++i) {
-            SPIwrite(buf_start, 1);
-        }
+    //! Begin a frame written directly in wire format: returns the back
+    //! buffer, whose contents are undefined, and all pixels must be written
+    //! before end_frame(), e.g. with encodeColor() or encodeRaw(). Writes to
+    //! the view do not mark pixels dirty, hence the frame must be sent with
+    //! end_frame(), show() would skip it.
+    WireView<APAColor> begin_frame() {
+        back_stale_ = false;
+        in_frame_ = true;
+        return WireView<APAColor>(strip_data_.data(), strip_size_);
     }
 
-    size_t size() const { return strip_size_; }
+    //! Send the frame written through begin_frame(). In async mode the back
+    //! buffer becomes the front buffer without copying, and the previous
+    //! front buffer is reused as the next back buffer.
+    void end_frame() {
+        in_frame_ = false;
+        clear_dirty();
 
-protected:
-    int SPIwrite(unsigned char* data, int len) {
+        if (!tx_thread_)
+            return transmit(strip_data_.data(), strip_size_);
 
-        cs_gpio_.write(1);
+        tx_thread_->wait();
+        strip_data_.swap(tx_data_);
+        tx_count_ = strip_size_;
+        tx_thread_->submit();
 
-        struct spi_ioc_transfer spi;
-        memset(&spi, 0, sizeof(spi));
+        // the back buffer now holds the previous frame
+        back_stale_ = true;
+    }
 
-        spi.tx_buf = (unsigned long)data;
-        spi.rx_buf = 0x0;
-        spi.len = len;
-        spi.delay_usecs = 0;
-        spi.speed_hz = spiSpeed_;
-        spi.bits_per_word = 8;
+    bool busy() const {
+        return tx_thread_ && tx_thread_->busy();
+    }
 
-        int x = ioctl(fd_, SPI_IOC_MESSAGE(1), &spi);
+    //! block until the frame in flight (if any) has been transmitted
+    void wait() {
+        if (tx_thread_)
+            tx_thread_->wait();
+    }
 
-        cs_gpio_.write(1);
+    void show() {
+        assert(!in_frame_ && "frames of begin_frame() are sent by end_frame()");
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+
+        // APA102 pixels latch in chain order and keep their color, hence it
+        // suffices to send the prefix up to the last changed pixel.
+        size_t count = std::min(dirty_end_, strip_size_);
+        clear_dirty();
+
+        if (!tx_thread_)
+            return transmit(strip_data_.data(), count);
+
+        // swap in the new front buffer once the previous frame is out
+        tx_thread_->wait();
+        std::copy(strip_data_.begin(), strip_data_.begin() + count,
+                  tx_data_.begin());
+        tx_count_ = count;
+        tx_thread_->submit();
+    }
+
+    size_t size() const { return strip_size_; }
+
+    //! spidev device, e.g. for its message counter
+    const PiSPI& spi() const { return spi_; }
+
+protected:
+    //! send start frame, the first count pixels, and end frame as one
+    //! scatter/gather frame
+    void transmit(const APAColor* data, size_t count) {
+        static const uint8_t s_start_frame[4] = { 0x00, 0x00, 0x00, 0x00 };
+
+        // a partial frame ends with zeros, which the next pixel in the chain
+        // takes as start frame instead of as a full white pixel.
+        uint8_t* end_frame = count < strip_size_
+                             ? partial_end_frame_.data() : end_frame_.data();
+
+        struct iovec iov[3];
+        iov[0].iov_base = const_cast<uint8_t*>(s_start_frame);
+        iov[0].iov_len = sizeof(s_start_frame);
+        iov[1].iov_base = const_cast<APAColor*>(data);
+        iov[1].iov_len = sizeof(APAColor) * count;
+        iov[2].iov_base = end_frame;
+        iov[2].iov_len = (count / 2 + 7) / 8;
 
-        return x;
+        cs_gpio_.write(1);
+        spi_.write(iov, 3);
+        cs_gpio_.write(0);
     }
 
 private:
     //! strip length
     size_t strip_size_;
 
-    //! device file descriptor
-    int fd_;
-
-    //! SPI speed
-    size_t spiSpeed_;
+    //! spidev device
+    PiSPI spi_;
 
     //! GPIO CS Pin for SPI multiplex
     GPIOPin cs_gpio_;
 
-    //! strip color data
+    //! strip color data, the back buffer in async mode
     std::vector<APAColor> strip_data_;
+
+    //! end frame: at least strip_size / 2 additional clock edges
+    std::vector<uint8_t> end_frame_;
+
+    //! end frame of partial updates
+    std::vector<uint8_t> partial_end_frame_;
+
+    //! front buffer being transmitted by the thread in async mode
+    std::vector<APAColor> tx_data_;
+
+    //! number of pixels of the front buffer to transmit
+    size_t tx_count_ = 0;
+
+    //! whether the back buffer lags the front buffer after end_frame()
+    bool back_stale_ = false;
+
+    //! between begin_frame() and end_frame()
+    bool in_frame_ = false;
+
+    //! transmit thread in async mode, destroyed first
+    std::unique_ptr<OutputThread> tx_thread_;
+
+    //! Bring the back buffer up to date with the frame in the front buffer
+    //! before pixels are modified individually. The transfer only reads the
+    //! front buffer, hence this need not wait for it.
+    void sync_back() {
+        if (back_stale_) {
+            std::copy(tx_data_.begin(), tx_data_.end(), strip_data_.begin());
+            back_stale_ = false;
+        }
+    }
+
+    //! encode a run of pixels in batches using the given gamma table
+    void setPixels(size_t first, const Color* colors, size_t n,
+                   const uint8_t* gamma) {
+        if (first >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - first);
+
+        APAColor batch[64];
+        for (size_t off = 0; off < n; off += 64) {
+            size_t run = std::min<size_t>(n - off, 64);
+            APA102Encoder::encode<Format>(batch, colors + off, run, gamma);
+            for (size_t k = 0; k < run; ++k)
+                store(first + off + k, batch[k]);
+        }
+    }
+
+    //! store encoded pixel, marking it dirty if it changed
+    void store(size_t index, const APAColor& c) {
+        sync_back();
+        if (strip_data_[index] != c) {
+            strip_data_[index] = c;
+            mark_dirty(index);
+        }
+    }
 };
 
 } // namespace BlinkenAlgorithms
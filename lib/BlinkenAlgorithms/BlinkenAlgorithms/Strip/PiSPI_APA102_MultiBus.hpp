@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/PiSPI_APA102_MultiBus.hpp
+ *
+ * One logical APA102 strip spanning several spidev devices, which are driven
+ * concurrently by one transmit thread per bus.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_PISPI_APA102_MULTIBUS_HEADER
+#define BLINKENALGORITHMS_STRIP_PISPI_APA102_MULTIBUS_HEADER
+
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Logical strip of equal segments on several buses. Format is the wire
+ * format of all segments, see PiSPI_APA102.
+ */
+template <typename Format = PixelFormatAPA102<> >
+class PiSPI_APA102_MultiBus : public LEDStripBase
+{
+public:
+    //! Open one spidev device per segment, e.g. { "/dev/spidev0.0",
+    //! "/dev/spidev1.0" }. Logical pixel i is on bus i / segment_size.
+    PiSPI_APA102_MultiBus(std::initializer_list<std::string> paths,
+                          size_t segment_size)
+        : PiSPI_APA102_MultiBus(std::vector<std::string>(paths),
+                                segment_size) { }
+
+    //! open one spidev device per entry of paths
+    PiSPI_APA102_MultiBus(const std::vector<std::string>& paths,
+                          size_t segment_size)
+        : segment_size_(segment_size), strip_size_(0) {
+        if (segment_size_ == 0) {
+            std::cerr << "PiSPI_APA102_MultiBus: segment size must not be zero"
+                      << std::endl;
+            return;
+        }
+        for (const std::string& path : paths) {
+            buses_.emplace_back(
+                new PiSPI_APA102<Format>(path, segment_size, /* cs_pin */ -1,
+                                         /* async */ true));
+        }
+        strip_size_ = segment_size_ * buses_.size();
+    }
+
+    size_t size() const { return strip_size_; }
+
+    size_t num_buses() const { return buses_.size(); }
+
+    void setPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            buses_[index / segment_size_]->setPixel(index % segment_size_, color);
+    }
+
+    void orPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            buses_[index / segment_size_]->orPixel(index % segment_size_, color);
+    }
+
+    void addPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            buses_[index / segment_size_]->addPixel(index % segment_size_, color);
+    }
+
+    //! set a run of pixels, splitting it at segment boundaries
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        while (n != 0 && first < strip_size_) {
+            size_t bus = first / segment_size_, offset = first % segment_size_;
+            size_t run = std::min(n, segment_size_ - offset);
+            buses_[bus]->setPixels(offset, colors, run);
+            first += run, colors += run, n -= run;
+        }
+    }
+
+    //! set a run of already gamma corrected pixels
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        while (n != 0 && first < strip_size_) {
+            size_t bus = first / segment_size_, offset = first % segment_size_;
+            size_t run = std::min(n, segment_size_ - offset);
+            buses_[bus]->setPixelsRaw(offset, colors, run);
+            first += run, colors += run, n -= run;
+        }
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (auto& bus : buses_)
+            bus->clear();
+    }
+
+    //! copy already encoded pixels, possibly between buses
+    void copyPixel(size_t dst, size_t src) {
+        if (dst < strip_size_ && src < strip_size_) {
+            buses_[dst / segment_size_]->setWirePixel(
+                dst % segment_size_,
+                buses_[src / segment_size_]->wirePixel(src % segment_size_));
+        }
+    }
+
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= strip_size_ || src >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - std::max(dst, src));
+        if (dst <= src) {
+            for (size_t i = 0; i < n; ++i)
+                copyPixel(dst + i, src + i);
+        }
+        else {
+            for (size_t i = n; i != 0; --i)
+                copyPixel(dst + i - 1, src + i - 1);
+        }
+    }
+
+    //! whether any segment is still being transmitted
+    bool busy() const {
+        for (const auto& bus : buses_) {
+            if (bus->busy())
+                return true;
+        }
+        return false;
+    }
+
+    //! whether any segment changed since the last show()
+    bool dirty() const {
+        for (const auto& bus : buses_) {
+            if (bus->dirty())
+                return true;
+        }
+        return false;
+    }
+
+    //! Show changed segments, unchanged ones are skipped by the buses.
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+
+        // barrier: all segments must have finished the previous frame, such
+        // that the next frame is started on all buses together.
+        for (auto& bus : buses_)
+            bus->wait();
+        for (auto& bus : buses_)
+            bus->show();
+    }
+
+private:
+    //! pixels per bus
+    size_t segment_size_;
+
+    //! total logical length
+    size_t strip_size_;
+
+    //! one asynchronous strip per spidev device
+    std::vector<std::unique_ptr<PiSPI_APA102<Format> > > buses_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_PISPI_APA102_MULTIBUS_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/PiSPI_WS2812.hpp
+ *
+ * Drive WS2812 (GRB) or SK6812 (GRBW) strips from a Linux spidev device by
+ * expanding the one-wire bitstream into SPI bit patterns.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_PISPI_WS2812_HEADER
+#define BLINKENALGORITHMS_STRIP_PISPI_WS2812_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Extra/OutputThread.hpp>
+#include <BlinkenAlgorithms/Extra/PiSPI.hpp>
+#include <BlinkenAlgorithms/Strip/LEDStripBase.hpp>
+#include <BlinkenAlgorithms/Strip/PixelFormat.hpp>
+#include <BlinkenAlgorithms/Strip/WS2812Encoder.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Format is the pixel's wire format: PixelFormatGRB for WS2812,
+ * PixelFormatGRBW for SK6812 RGBW strips.
+ *
+ * The whole frame must fit into one SPI message: spidev's default bufsiz of
+ * 4096 bytes holds only about 450 RGB pixels, and frames are split into
+ * several ioctls beyond that. The line idles low between them, which strips
+ * may take as reset and latch a partial frame. Load spidev with a larger
+ * buffer, e.g. spidev.bufsiz=65536 on the kernel command line; the
+ * constructor warns if the frame exceeds it.
+ */
+template <typename Format = PixelFormatGRB>
+class PiSPI_WS2812 : public LEDStripBase
+{
+public:
+    //! Open SPI strip on MOSI. If async is set, show() only hands the frame
+    //! to a dedicated transmit thread.
+    PiSPI_WS2812(std::string path, size_t strip_size, bool async = false)
+        : strip_size_(strip_size),
+          colors_(strip_size, Color(0)),
+          strip_data_(strip_size * pixel_bytes_),
+          reset_((reset_us_ * (WS2812Encoder::spi_speed_hz / 1000) / 1000 + 7)
+                 / 8, 0x00) {
+
+        for (size_t i = 0; i < strip_size_; ++i)
+            encodePixel(i);
+
+        // mode 0: MOSI idles low between frames
+        if (!spi_.open(path, WS2812Encoder::spi_speed_hz, /* mode */ 0)) {
+            std::cerr << "PiSPI_WS2812 failed" << std::endl;
+            return;
+        }
+
+        size_t frame = strip_data_.size() + reset_.size();
+        if (frame > spi_.max_transfer() && !spi_.is_mock()) {
+            std::cerr << "PiSPI_WS2812: frame of " << frame
+                      << " bytes exceeds spidev bufsiz " << spi_.bufsiz()
+                      << ", the strip may latch partial frames."
+                      << " Set spidev.bufsiz=" << frame << " or more."
+                      << std::endl;
+        }
+
+        if (async) {
+            tx_data_.resize(strip_data_.size());
+            tx_thread_.reset(new OutputThread(
+                [this]() { transmit(tx_data_.data(), tx_count_); }));
+        }
+    }
+
+    size_t size() const { return strip_size_; }
+
+    void setPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, gamma(color));
+    }
+
+    //! set a run of pixels starting at first
+    void setPixels(size_t first, const Color* colors, size_t n) {
+        if (first >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - first);
+        for (size_t i = 0; i < n; ++i)
+            store(first + i, gamma(colors[i]));
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        if (first >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - first);
+        for (size_t i = 0; i < n; ++i)
+            store(first + i, colors[i]);
+    }
+
+    //! set all pixels to black
+    void clear() {
+        for (size_t i = 0; i < strip_size_; ++i)
+            store(i, Color(0));
+    }
+
+    //! gamma corrected color of a pixel
+    Color getPixel(size_t index) const {
+        return index < strip_size_ ? colors_[index] : Color(0);
+    }
+
+    void orPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, colors_[index] | gamma(color));
+    }
+
+    void addPixel(size_t index, const Color& color) {
+        if (index < strip_size_)
+            store(index, colors_[index] + gamma(color));
+    }
+
+    //! copy a pixel without gamma correcting it again
+    void copyPixel(size_t dst, size_t src) {
+        if (dst < strip_size_ && src < strip_size_)
+            store(dst, colors_[src]);
+    }
+
+    //! copy a run of pixels, ranges may overlap
+    void copyPixels(size_t dst, size_t src, size_t n) {
+        if (dst >= strip_size_ || src >= strip_size_)
+            return;
+        n = std::min(n, strip_size_ - std::max(dst, src));
+        if (memcmp(&colors_[dst], &colors_[src], n * sizeof(Color)) == 0)
+            return;
+        memmove(&colors_[dst], &colors_[src], n * sizeof(Color));
+        memmove(&strip_data_[dst * pixel_bytes_],
+                &strip_data_[src * pixel_bytes_], n * pixel_bytes_);
+        mark_dirty(dst, dst + n);
+    }
+
+    //! access expanded SPI bitstream of a pixel, pixel_bytes() long
+    const uint8_t* wirePixel(size_t index) const {
+        return &strip_data_[index * pixel_bytes_];
+    }
+
+    //! SPI bytes per pixel
+    static size_t pixel_bytes() { return pixel_bytes_; }
+
+    //! zero bytes sent after the pixels to latch the frame
+    size_t reset_bytes() const { return reset_.size(); }
+
+    //! spidev device, e.g. for its message counter
+    const PiSPI& spi() const { return spi_; }
+
+    bool busy() const {
+        return tx_thread_ && tx_thread_->busy();
+    }
+
+    //! block until the frame in flight (if any) has been transmitted
+    void wait() {
+        if (tx_thread_)
+            tx_thread_->wait();
+    }
+
+    void show() {
+        if (!dirty()) {
+            ++skipped_frames_;
+            return;
+        }
+
+        // pixels consume their bits in chain order and keep their color
+        // until the next reset, hence only the changed prefix is sent.
+        size_t count = std::min(dirty_end_, strip_size_);
+        clear_dirty();
+
+        if (!tx_thread_)
+            return transmit(strip_data_.data(), count);
+
+        tx_thread_->wait();
+        std::copy(strip_data_.begin(),
+                  strip_data_.begin() + count * pixel_bytes_,
+                  tx_data_.begin());
+        tx_count_ = count;
+        tx_thread_->submit();
+    }
+
+protected:
+    //! Send the first count pixels and the reset tail in one batch. Transfers
+    //! may only be split between pixels, where the line is low: a pause in a
+    //! high phase would turn a zero bit into a one.
+    void transmit(const uint8_t* data, size_t count) {
+        size_t len = count * pixel_bytes_;
+        size_t segment =
+            std::max<size_t>(spi_.max_transfer() / pixel_bytes_, 1)
+            * pixel_bytes_;
+
+        iov_.clear();
+        for (size_t off = 0; off < len; off += segment) {
+            struct iovec iov;
+            iov.iov_base = const_cast<uint8_t*>(data + off);
+            iov.iov_len = std::min(segment, len - off);
+            iov_.push_back(iov);
+        }
+
+        struct iovec iov;
+        iov.iov_base = reset_.data();
+        iov.iov_len = reset_.size();
+        iov_.push_back(iov);
+
+        spi_.write(iov_.data(), iov_.size());
+    }
+
+private:
+    //! low time latching the frame, newer WS2812B need more than 280us
+    static const size_t reset_us_ = 300;
+
+    //! SPI bytes per pixel
+    static const size_t pixel_bytes_ =
+        Format::bytes * WS2812Encoder::expansion;
+
+    //! strip length
+    size_t strip_size_;
+
+    //! spidev device
+    PiSPI spi_;
+
+    //! gamma corrected colors, used to detect changes and to read back
+    std::vector<Color> colors_;
+
+    //! expanded bitstream, the back buffer in async mode
+    std::vector<uint8_t> strip_data_;
+
+    //! zero bytes holding the line low to latch the frame
+    std::vector<uint8_t> reset_;
+
+    //! front buffer being transmitted by the thread in async mode
+    std::vector<uint8_t> tx_data_;
+
+    //! number of pixels of the front buffer to transmit
+    size_t tx_count_ = 0;
+
+    //! scatter/gather list of the frame being transmitted
+    std::vector<struct iovec> iov_;
+
+    //! transmit thread in async mode, destroyed first
+    std::unique_ptr<OutputThread> tx_thread_;
+
+    Color gamma(const Color& c) const {
+        return Color(gamma8(c.r), gamma8(c.g), gamma8(c.b), gamma8(c.w));
+    }
+
+    //! store gamma corrected color, encoding and marking it if it changed
+    void store(size_t index, const Color& c) {
+        if (colors_[index].v != c.v) {
+            colors_[index] = c;
+            encodePixel(index);
+            mark_dirty(index);
+        }
+    }
+
+    //! expand pixel into the bitstream in wire format order
+    void encodePixel(size_t index) {
+        uint8_t raw[Format::bytes];
+        Format::encode(raw, colors_[index]);
+        WS2812Encoder::encode(
+            &strip_data_[index * pixel_bytes_], raw, Format::bytes);
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_PISPI_WS2812_HEADER
+
+/******************************************************************************/
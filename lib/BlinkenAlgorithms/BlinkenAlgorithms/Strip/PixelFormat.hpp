@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/PixelFormat.hpp
+ *
+ * Compile-time pixel wire formats: channel order and layout of the bytes a
+ * driver sends per pixel.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_PIXELFORMAT_HEADER
+#define BLINKENALGORITHMS_STRIP_PIXELFORMAT_HEADER
+
+#include <BlinkenAlgorithms/Color.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Byte-per-channel wire format with the byte positions of red, green, blue
+ * and white (-1 = no white channel) as template parameters. Drivers take the
+ * format as a template parameter, hence the packing loops are generated for
+ * the fixed layout without branches and vectorize to byte shuffles.
+ */
+template <int RPos, int GPos, int BPos, int WPos = -1>
+struct PixelFormat {
+    static const bool has_white = (WPos >= 0);
+
+    //! wire bytes per pixel
+    static const size_t bytes = has_white ? 4 : 3;
+
+    //! byte positions of the channels
+    static const int r_pos = RPos, g_pos = GPos, b_pos = BPos, w_pos = WPos;
+
+    static_assert(RPos >= 0 && RPos < int(bytes) && GPos >= 0 &&
+                  GPos < int(bytes) && BPos >= 0 && BPos < int(bytes) &&
+                  WPos < int(bytes), "channel position out of range");
+
+    //! whether channels are in R, G, B(, W) order
+    static const bool is_rgb = (RPos == 0 && GPos == 1 && BPos == 2);
+
+    static void encode(uint8_t* dst, const Color& c) {
+        dst[RPos] = c.r;
+        dst[GPos] = c.g;
+        dst[BPos] = c.b;
+        if (has_white)
+            dst[has_white ? WPos : 0] = c.w;
+    }
+
+    //! pack n colors into n * bytes wire bytes
+    static void encode(uint8_t* __restrict dst, const Color* __restrict src,
+                       size_t n) {
+        for (size_t i = 0; i < n; ++i, dst += bytes)
+            encode(dst, src[i]);
+    }
+
+    //! unpack a wire pixel, e.g. to verify transmitted frames
+    static Color decode(const uint8_t* src) {
+        return Color(src[RPos], src[GPos], src[BPos],
+                     has_white ? src[has_white ? WPos : 0] : 0);
+    }
+};
+
+using PixelFormatRGB = PixelFormat<0, 1, 2>;
+using PixelFormatGRB = PixelFormat<1, 0, 2>;
+using PixelFormatBGR = PixelFormat<2, 1, 0>;
+using PixelFormatRGBW = PixelFormat<0, 1, 2, 3>;
+using PixelFormatGRBW = PixelFormat<1, 0, 2, 3>;
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_PIXELFORMAT_HEADER
+
+/******************************************************************************/
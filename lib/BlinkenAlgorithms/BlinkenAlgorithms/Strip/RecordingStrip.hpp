@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/RecordingStrip.hpp
+ *
+ * Strip which records each shown frame into a FrameLog before passing it on.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_RECORDINGSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_RECORDINGSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Extra/FrameLog.hpp>
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+
+#include <string>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Framebuffer in front of a strip, like FramebufferStrip, which appends every
+ * frame to a log file in show(). Recording costs one compare pass over the
+ * frame plus encoding of the changed pixels, hence it can stay enabled live.
+ * Replay a log with ReplayFrameLog().
+ */
+template <typename BaseStrip>
+class RecordingStrip : public Framebuffer
+{
+public:
+    RecordingStrip(BaseStrip& base, const std::string& path,
+                   size_t keyframe_interval = 256)
+        : Framebuffer(base.size()), base_(base) {
+        log_.open(path, base.size(), keyframe_interval);
+    }
+
+    void show() {
+        log_.append(data());
+        base_.setPixels(0, data(), size());
+        base_.show();
+    }
+
+    bool busy() const {
+        return base_.busy();
+    }
+
+    uint8_t intensity() const {
+        return base_.intensity();
+    }
+    void set_intensity(uint8_t intensity) {
+        return base_.set_intensity(intensity);
+    }
+
+    size_t skipped_frames() const {
+        return base_.skipped_frames();
+    }
+
+    BaseStrip& base() { return base_; }
+
+    FrameLogWriter& log() { return log_; }
+
+private:
+    BaseStrip& base_;
+
+    FrameLogWriter log_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_RECORDINGSTRIP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/ShmStrip.hpp
+ *
+ * Strip which publishes its frames into a shared-memory frame ring, from
+ * which a separate output daemon drives the LEDs.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_SHMSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_SHMSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Extra/ShmFrameRing.hpp>
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+
+#include <iostream>
+#include <string>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Producer side of a ShmFrameRing: animations render into the framebuffer and
+ * show() publishes it without waiting for any consumer. Colors are published
+ * before gamma correction, which is left to the consumer's driver.
+ */
+class ShmStrip : public Framebuffer
+{
+public:
+    ShmStrip(const std::string& name, size_t strip_size)
+        : Framebuffer(strip_size) {
+        if (!ring_.create(name, strip_size))
+            std::cerr << "ShmStrip failed" << std::endl;
+    }
+
+    void show() {
+        if (ring_.is_open())
+            ring_.publish(data(), size());
+    }
+
+    //! number of the last published frame
+    uint32_t frame() const {
+        return ring_.is_open() ? ring_.latest() : 0;
+    }
+
+private:
+    ShmFrameRing ring_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_SHMSTRIP_HEADER
+
+/******************************************************************************/
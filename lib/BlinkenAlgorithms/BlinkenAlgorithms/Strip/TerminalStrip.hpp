@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/TerminalStrip.hpp
+ *
+ * Preview strip drawing the pixels into a terminal with ANSI true-color
+ * escape sequences.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_TERMINALSTRIP_HEADER
+#define BLINKENALGORITHMS_STRIP_TERMINALSTRIP_HEADER
+
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Framebuffer drawn as rows of colored cells, one per pixel, wrapping at the
+ * terminal width. show() redraws at most max_fps times per second and drops
+ * the frames in between, such that animations run at full speed.
+ */
+class TerminalStrip : public Framebuffer
+{
+public:
+    TerminalStrip(size_t strip_size, unsigned max_fps = 30,
+                  FILE* out = stdout)
+        : Framebuffer(strip_size), out_(out),
+          interval_(std::chrono::microseconds(
+                        1000000 / std::max(max_fps, 1u))) {
+        // animations scale colors by intensity, preview them at full
+        intensity_ = 255;
+
+        struct winsize ws;
+        width_ = 80;
+        if (ioctl(fileno(out_), TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+            width_ = ws.ws_col;
+
+        // clear screen and hide cursor
+        fputs("\x1b[2J\x1b[?25l", out_);
+        fflush(out_);
+    }
+
+    ~TerminalStrip() {
+        // reset colors and show cursor
+        fputs("\x1b[0m\x1b[?25h\n", out_);
+        fflush(out_);
+    }
+
+    void show() {
+        ++shows_;
+        clock::time_point now = clock::now();
+        if (now < next_) {
+            ++dropped_frames_;
+            return;
+        }
+        next_ = now + interval_;
+        draw();
+    }
+
+    //! set a run of already gamma corrected pixels, see OutputPipeline
+    void setPixelsRaw(size_t first, const Color* colors, size_t n) {
+        setPixels(first, colors, n);
+    }
+
+    //! number of show() calls
+    size_t shows() const { return shows_; }
+
+    //! number of show() calls not drawn due to the rate limit
+    size_t dropped_frames() const { return dropped_frames_; }
+
+    //! draw the current pixels
+    void draw() {
+        // cursor home, then one background color escape per color change
+        line_.assign("\x1b[H");
+        const Color* c = data();
+        uint32_t last = ~uint32_t(0);
+        char esc[32];
+        for (size_t i = 0; i < size(); ++i) {
+            if (i != 0 && i % width_ == 0) {
+                line_ += "\x1b[0m\n";
+                last = ~uint32_t(0);
+            }
+            if (c[i].v != last) {
+                last = c[i].v;
+                // mix white channel into RGB
+                snprintf(esc, sizeof(esc), "\x1b[48;2;%u;%u;%um",
+                         mix(c[i].r, c[i].w), mix(c[i].g, c[i].w),
+                         mix(c[i].b, c[i].w));
+                line_ += esc;
+            }
+            line_ += ' ';
+        }
+        line_ += "\x1b[0m\n";
+
+        fwrite(line_.data(), 1, line_.size(), out_);
+        fflush(out_);
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    FILE* out_;
+
+    //! terminal columns
+    size_t width_;
+
+    //! minimum time between two redraws
+    clock::duration interval_;
+    clock::time_point next_;
+
+    size_t shows_ = 0;
+    size_t dropped_frames_ = 0;
+
+    //! escape sequences of one redraw
+    std::string line_;
+
+    static unsigned mix(uint8_t c, uint8_t w) {
+        return std::min(unsigned(c) + w, 255u);
+    }
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_TERMINALSTRIP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/WS2812Encoder.hpp
+ *
+ * Expand bytes of the WS2812/SK6812 one-wire NRZ protocol into SPI bit
+ * patterns: each data bit becomes three SPI bits, 0 -> 100 and 1 -> 110.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_WS2812ENCODER_HEADER
+#define BLINKENALGORITHMS_STRIP_WS2812ENCODER_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace BlinkenAlgorithms {
+
+class WS2812Encoder
+{
+public:
+    //! SPI bytes per data byte
+    static const size_t expansion = 3;
+
+    //! SPI clock at which three SPI bits take one 1.25us data bit, giving
+    //! high times of 417ns for zero and 833ns for one bits.
+    static const uint32_t spi_speed_hz = 2400000;
+
+    //! expand one data byte into three SPI bytes
+    static void encode(uint8_t* dst, uint8_t v) {
+        memcpy(dst, patterns()[v].bytes, expansion);
+    }
+
+    //! expand n data bytes into 3 * n SPI bytes
+    static void encode(uint8_t* dst, const uint8_t* src, size_t n) {
+        const Pattern* patterns = WS2812Encoder::patterns();
+        for (size_t i = 0; i < n; ++i, dst += expansion)
+            memcpy(dst, patterns[src[i]].bytes, expansion);
+    }
+
+    //! Recover a data byte from three SPI bytes by sampling the middle bit of
+    //! each pattern. Used to read back pixels and to verify bitstreams.
+    static uint8_t decode(const uint8_t* src) {
+        uint32_t x = (uint32_t(src[0]) << 16) | (uint32_t(src[1]) << 8) | src[2];
+        uint8_t v = 0;
+        for (size_t k = 0; k < 8; ++k)
+            v = (v << 1) | ((x >> (3 * (7 - k) + 1)) & 1);
+        return v;
+    }
+
+    //! whether a three byte sequence is a valid expansion of some data byte
+    static bool valid(const uint8_t* src) {
+        uint8_t v = decode(src);
+        return memcmp(src, patterns()[v].bytes, expansion) == 0;
+    }
+
+private:
+    struct Pattern {
+        uint8_t bytes[expansion];
+    };
+
+    //! table of the 24-bit patterns of all byte values, MSB first
+    static const Pattern* patterns() {
+        static const PatternTable s_table;
+        return s_table.patterns;
+    }
+
+    struct PatternTable {
+        Pattern patterns[256];
+
+        PatternTable() {
+            for (unsigned v = 0; v < 256; ++v) {
+                uint32_t x = 0;
+                for (unsigned k = 0; k < 8; ++k)
+                    x = (x << 3) | ((v & (0x80 >> k)) ? 0b110 : 0b100);
+                patterns[v].bytes[0] = x >> 16;
+                patterns[v].bytes[1] = x >> 8;
+                patterns[v].bytes[2] = x;
+            }
+        }
+    };
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_WS2812ENCODER_HEADER
+
+/******************************************************************************/
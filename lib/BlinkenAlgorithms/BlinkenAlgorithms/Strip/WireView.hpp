@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Strip/WireView.hpp
+ *
+ * Typed view of a driver's transmit buffer, through which frames are written
+ * in the driver's wire format without an intermediate copy.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_STRIP_WIREVIEW_HEADER
+#define BLINKENALGORITHMS_STRIP_WIREVIEW_HEADER
+
+#include <cstddef>
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Array of encoded pixels, e.g. APAColor for PiSPI_APA102, handed out by a
+ * driver's begin_frame(). The view is valid until the matching end_frame().
+ */
+template <typename Pixel>
+class WireView
+{
+public:
+    WireView(Pixel* data, size_t size)
+        : data_(data), size_(size) { }
+
+    size_t size() const { return size_; }
+
+    Pixel* data() const { return data_; }
+
+    Pixel& operator [] (size_t i) const { return data_[i]; }
+
+    Pixel* begin() const { return data_; }
+    Pixel* end() const { return data_ + size_; }
+
+private:
+    Pixel* data_;
+    size_t size_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#endif // !BLINKENALGORITHMS_STRIP_WIREVIEW_HEADER
+
+/******************************************************************************/
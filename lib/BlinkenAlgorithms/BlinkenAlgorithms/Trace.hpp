@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * lib/BlinkenAlgorithms/BlinkenAlgorithms/Trace.hpp
+ *
+ * Compile-time switchable timing spans, exported as Chrome trace-event JSON
+ * which chrome://tracing or ui.perfetto.dev display as a timeline.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#ifndef BLINKENALGORITHMS_TRACE_HEADER
+#define BLINKENALGORITHMS_TRACE_HEADER
+
+//! compile with -DBLINKEN_TRACE=1 to record spans, otherwise they vanish
+#ifndef BLINKEN_TRACE
+#define BLINKEN_TRACE 0
+#endif
+
+#if BLINKEN_TRACE
+
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace BlinkenAlgorithms {
+
+/*!
+ * Per-thread ring of the last events spans recorded. Only the owning thread
+ * writes, hence recording needs no locks or atomic read-modify-writes. Rings
+ * are never freed, such that spans of exited threads are dumped as well.
+ */
+class TraceRing
+{
+public:
+    //! spans kept per thread, older ones are overwritten
+    static const size_t events = 1 << 16;
+
+    struct Event {
+        //! static string, usually a literal
+        const char* name;
+        //! in Trace::now_ticks()
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    explicit TraceRing(size_t tid) : tid_(tid), ring_(size_t(events)) { }
+
+    void record(const char* name, uint64_t begin, uint64_t end) {
+        size_t h = head_.load(std::memory_order_relaxed);
+        Event& e = ring_[h % events];
+        e.name = name, e.begin = begin, e.end = end;
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    //! Write events as JSON objects with times in microseconds since tick
+    //! zero. Events the owner overwrites meanwhile may come out garbled, dump
+    //! from a quiet thread or at exit.
+    void dump(FILE* out, bool& first, uint64_t zero, double us_per_tick) const {
+        size_t h = head_.load(std::memory_order_acquire);
+        for (size_t i = h > events ? h - events : 0; i < h; ++i) {
+            const Event& e = ring_[i % events];
+            fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+                    "\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",", e.name, tid_,
+                    double(int64_t(e.begin - zero)) * us_per_tick,
+                    double(e.end - e.begin) * us_per_tick);
+            first = false;
+        }
+    }
+
+private:
+    size_t tid_;
+    std::vector<Event> ring_;
+    //! number of events recorded
+    std::atomic<size_t> head_ { 0 };
+};
+
+/*!
+ * Registry of all threads' rings. The trace is written to the file named by
+ * BLINKEN_TRACE_FILE, default blinken-trace.json, at exit and on SIGUSR1.
+ * The signal only sets a flag: the next span to end writes the file, as
+ * stdio is not async-signal-safe.
+ */
+class Trace
+{
+public:
+    static uint64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    //! Span timestamps: the CPU's cycle or virtual counter where user space
+    //! can read it, which is several times cheaper than clock_gettime(). The
+    //! rate is calibrated against now_ns() when dumping.
+    static uint64_t now_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (v));
+        return v;
+#else
+        return now_ns();
+#endif
+    }
+
+    //! the calling thread's ring, created on first use
+    static TraceRing& ring() {
+        thread_local TraceRing* ring = nullptr;
+        if (!ring)
+            ring = add_ring();
+        return *ring;
+    }
+
+    static void record(const char* name, uint64_t begin) {
+        ring().record(name, begin, now_ticks());
+        if (dump_requested().load(std::memory_order_relaxed)) {
+            dump_requested().store(false, std::memory_order_relaxed);
+            dump();
+        }
+    }
+
+    //! write all rings as a Chrome trace-event JSON file
+    static void dump() {
+        const char* path = getenv("BLINKEN_TRACE_FILE");
+        if (!path)
+            path = "blinken-trace.json";
+        FILE* out = fopen(path, "w");
+        if (!out) {
+            perror(path);
+            return;
+        }
+        fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+        bool first = true;
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            uint64_t ns = now_ns(), ticks = now_ticks();
+            double us_per_tick = ticks == s.start_ticks ? 0.0 :
+                                 (ns - s.start_ns) / 1000.0 /
+                                 (ticks - s.start_ticks);
+            for (const TraceRing* r : s.rings)
+                r->dump(out, first, s.start_ticks, us_per_tick);
+        }
+        fputs("\n]}\n", out);
+        fclose(out);
+        fprintf(stderr, "trace written to %s\n", path);
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<TraceRing*> rings;
+        //! clocks when the first ring was created, for calibration
+        uint64_t start_ns, start_ticks;
+    };
+
+    static State& state() {
+        // leaked, such that the atexit() dump can still use it
+        static State* s = new State;
+        return *s;
+    }
+
+    static std::atomic<bool>& dump_requested() {
+        static std::atomic<bool> flag { false };
+        return flag;
+    }
+
+    static TraceRing* add_ring() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.rings.empty()) {
+            s.start_ns = now_ns();
+            s.start_ticks = now_ticks();
+            atexit([]() { dump(); });
+            signal(SIGUSR1, [](int) {
+                       dump_requested().store(true, std::memory_order_relaxed);
+                   });
+        }
+        s.rings.push_back(new TraceRing(s.rings.size()));
+        return s.rings.back();
+    }
+};
+
+//! records the time from construction to destruction as a span
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name)
+        : name_(name), begin_(Trace::now_ticks()) { }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator = (const TraceSpan&) = delete;
+
+    ~TraceSpan() {
+        Trace::record(name_, begin_);
+    }
+
+private:
+    const char* name_;
+    uint64_t begin_;
+};
+
+} // namespace BlinkenAlgorithms
+
+#define BLINKEN_TRACE_JOIN2(a, b) a ## b
+#define BLINKEN_TRACE_JOIN(a, b) BLINKEN_TRACE_JOIN2(a, b)
+
+//! record a span from here to the end of the enclosing scope
+#define BLINKEN_TRACE_SPAN(name) \
+    ::BlinkenAlgorithms::TraceSpan BLINKEN_TRACE_JOIN(trace_, __LINE__)(name)
+
+#else
+
+#define BLINKEN_TRACE_SPAN(name)
+
+#endif // BLINKEN_TRACE
+
+#endif // !BLINKENALGORITHMS_TRACE_HEADER
+
+/******************************************************************************/
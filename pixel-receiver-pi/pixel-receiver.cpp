@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * pixel-receiver-pi/pixel-receiver.cpp
+ *
+ * Pixel controller: receive DDP or E1.31 (sACN) frames from lighting software
+ * and show them on an APA102 strip.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Extra/PixelReceiver.hpp>
+#include <BlinkenAlgorithms/Strip/Framebuffer.hpp>
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace BlinkenAlgorithms;
+
+volatile sig_atomic_t g_terminate = 0;
+
+void signal_handler(int) {
+    g_terminate = 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <ddp|e131> [strip size] [spidev] [first universe]"
+                  << std::endl;
+        return 1;
+    }
+    std::string protocol = argv[1];
+    size_t strip_size = argc >= 3 ? atoi(argv[2]) : 5 * 96;
+    std::string spidev = argc >= 4 ? argv[3] : "/dev/spidev0.0";
+    uint16_t first_universe = argc >= 5 ? atoi(argv[4]) : 1;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    PiSPI_APA102<> base_strip(spidev, strip_size, /* cs_pin */ -1,
+                            /* async */ true);
+    FramebufferStrip<PiSPI_APA102<> > strip(base_strip);
+
+    using Receiver = PixelReceiver<FramebufferStrip<PiSPI_APA102<> > >;
+    Receiver receiver(strip);
+    if (!receiver.open(protocol == "e131" ? Receiver::e131 : Receiver::ddp,
+                       /* port */ 0, first_universe))
+        return 1;
+
+    auto last_report = std::chrono::steady_clock::now();
+    while (!g_terminate) {
+        receiver.poll(/* timeout_ms */ 100);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report < std::chrono::seconds(5))
+            continue;
+        last_report = now;
+
+        const Receiver::Stats& s = receiver.stats();
+        std::cerr << s.frames / 5.0 << " fps, " << s.packets << " packets, "
+                  << s.lost << " lost, " << s.out_of_order
+                  << " out of order, " << s.malformed << " malformed, "
+                  << "latency avg " << s.latency_avg_us() << " us max "
+                  << s.latency_max_us << " us" << std::endl;
+        receiver.reset_stats();
+    }
+
+    strip.clear();
+    strip.show();
+    base_strip.wait();
+
+    return 0;
+}
+
+/******************************************************************************/
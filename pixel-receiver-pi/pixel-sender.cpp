@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * pixel-receiver-pi/pixel-sender.cpp
+ *
+ * Test sender for pixel-receiver: streams a moving rainbow as DDP or E1.31
+ * frames, e.g. over loopback. With fps 0 frames are sent as fast as possible
+ * to measure throughput.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Color.hpp>
+#include <BlinkenAlgorithms/Extra/DDP.hpp>
+#include <BlinkenAlgorithms/Extra/E131.hpp>
+#include <BlinkenAlgorithms/Strip/NetworkStrip.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace BlinkenAlgorithms;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <ddp|e131> [strip size] [host] [fps] [frames]"
+                  << std::endl;
+        return 1;
+    }
+    bool e131 = std::string(argv[1]) == "e131";
+    size_t strip_size = argc >= 3 ? atoi(argv[2]) : 5 * 96;
+    const char* host = argc >= 4 ? argv[3] : "127.0.0.1";
+    unsigned fps = argc >= 5 ? atoi(argv[4]) : 60;
+    size_t frames = argc >= 6 ? atoi(argv[5]) : size_t(-1);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(e131 ? uint16_t(E131::port) : uint16_t(DDP::port));
+    if (fd < 0 || inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        std::cerr << "invalid host " << host << std::endl;
+        return 1;
+    }
+    auto send = [&](const uint8_t* buf, size_t len) {
+        sendto(fd, buf, len, 0, reinterpret_cast<struct sockaddr*>(&addr),
+               sizeof(addr));
+    };
+
+    std::unique_ptr<NetworkStrip<> > ddp_strip;
+    if (!e131)
+        ddp_strip.reset(new NetworkStrip<>(host, strip_size));
+
+    std::vector<Color> colors(strip_size);
+    std::vector<uint8_t> rgb(strip_size * 3);
+    uint8_t buf[1500];
+    const uint8_t cid[16] = { 'b', 'l', 'i', 'n', 'k', 'e', 'n' };
+    uint8_t seq = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    size_t f;
+    for (f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < strip_size; ++i) {
+            Color c = WheelColor(
+                ((i + f) * 256 / strip_size) % 256, /* intensity */ 255);
+            colors[i] = c;
+            rgb[3 * i + 0] = c.r;
+            rgb[3 * i + 1] = c.g;
+            rgb[3 * i + 2] = c.b;
+        }
+
+        if (!e131) {
+            ddp_strip->setPixelsRaw(0, colors.data(), strip_size);
+            ddp_strip->show();
+        }
+        else {
+            // 170 RGB pixels per universe, latched by a sync packet
+            ++seq;
+            uint16_t universe = 1;
+            for (size_t off = 0; off < rgb.size(); off += 510, ++universe) {
+                size_t n = std::min<size_t>(510, rgb.size() - off);
+                size_t len = E131::write_data_header(
+                    buf, cid, "pixel-sender", universe, seq,
+                    /* sync_address */ 1, n);
+                memcpy(buf + E131::header_size, &rgb[off], n);
+                send(buf, len);
+            }
+            send(buf, E131::write_sync(buf, cid, seq, 1));
+        }
+
+        if (fps) {
+            next += std::chrono::microseconds(1000000 / fps);
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cerr << f << " frames of " << strip_size << " pixels in "
+              << seconds << " s: " << f / seconds << " fps";
+    if (ddp_strip)
+        std::cerr << ", " << ddp_strip->send_errors() << " send errors";
+    std::cerr << std::endl;
+
+    close(fd);
+    return 0;
+}
+
+/******************************************************************************/
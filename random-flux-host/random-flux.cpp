@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * random-flux-host/random-flux.cpp
+ *
+ * Run the flux animations on a Linux host without LEDs: headless for
+ * profiling, or previewed in the terminal.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Porting/RaspberryPi.hpp>
+
+#include <BlinkenAlgorithms/Animation/Flux.hpp>
+#include <BlinkenAlgorithms/RunAnimation.hpp>
+#include <BlinkenAlgorithms/Strip/NullStrip.hpp>
+#include <BlinkenAlgorithms/Strip/TerminalStrip.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+using namespace BlinkenAlgorithms;
+
+bool g_terminate = false;
+
+//! deadline of the run and statistics printed on reaching it
+std::chrono::steady_clock::time_point g_deadline;
+std::chrono::steady_clock::time_point g_start;
+std::function<size_t()> g_frames;
+
+void delay_poll() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < g_deadline)
+        return;
+
+    double seconds = std::chrono::duration<double>(now - g_start).count();
+    size_t frames = g_frames();
+    printf("%zu frames in %.2f s: %.0f fps\n",
+           frames, seconds, frames / seconds);
+    exit(0);
+}
+
+//! print timing statistics of each finished animation
+void print_stats(size_t a, const AnimationStats& s) {
+    printf("animation %2zu: %6zu frames, %4zu skipped, lateness mean %6.0f us,"
+           " max %7u us, <100us %zu <1ms %zu <10ms %zu more %zu\n",
+           a, s.frames, s.skipped, s.lateness_mean(), unsigned(s.lateness_max),
+           s.lateness_hist[0], s.lateness_hist[1], s.lateness_hist[2],
+           s.lateness_hist[3]);
+}
+
+int main(int argc, char* argv[]) {
+    // arguments: [null|term] [seconds] [strip size]
+    bool terminal = argc >= 2 && std::string(argv[1]) == "term";
+    size_t seconds = argc >= 3 ? atoi(argv[2]) : 60;
+    size_t strip_size = argc >= 4 ? atoi(argv[3]) : 5 * 96;
+
+    srandom(time(nullptr));
+    FluxStatsHook = print_stats;
+
+    g_start = std::chrono::steady_clock::now();
+    g_deadline = g_start + std::chrono::seconds(seconds);
+
+    if (terminal) {
+        static TerminalStrip strip(strip_size);
+        g_frames = []() { return strip.shows(); };
+        RunRandomFluxAnimations(strip);
+    }
+    else {
+        static NullStrip strip(strip_size);
+        g_frames = []() { return strip.shows(); };
+        RunRandomFluxAnimations(strip);
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -9,20 +9,39 @@
 #include <BlinkenAlgorithms/Porting/RaspberryPi.hpp>
 
 #include <BlinkenAlgorithms/Animation/Flux.hpp>
+#include <BlinkenAlgorithms/Extra/RealTime.hpp>
 #include <BlinkenAlgorithms/RunAnimation.hpp>
+#include <BlinkenAlgorithms/Strip/OutputPipeline.hpp>
 #include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
 
+#include <cstdio>
+
 using namespace BlinkenAlgorithms;
 
-using Strip = PiSPI_APA102;
-Strip strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
+PiSPI_APA102<> base_strip("/dev/spidev0.0", /* strip_size */ 5 * 96);
+
+// render into memory at full intensity, apply brightness and gamma, then
+// encode and transmit the whole frame in show()
+using Strip = PipelineStrip<PiSPI_APA102<> >;
+Strip strip(base_strip);
 
 bool g_terminate = false;
 
 void delay_poll() { }
 
+//! print timing statistics of each finished animation
+void print_stats(size_t a, const AnimationStats& s) {
+    printf("animation %2zu: %6zu frames, %4zu skipped, lateness mean %6.0f us,"
+           " max %7u us, <100us %zu <1ms %zu <10ms %zu more %zu\n",
+           a, s.frames, s.skipped, s.lateness_mean(), unsigned(s.lateness_max),
+           s.lateness_hist[0], s.lateness_hist[1], s.lateness_hist[2],
+           s.lateness_hist[3]);
+}
+
 int main() {
     srandom(time(nullptr));
+    RealTime::configure_from_env(RealTime::Render);
+    FluxStatsHook = print_stats;
 
     RunRandomFluxAnimations(strip);
 
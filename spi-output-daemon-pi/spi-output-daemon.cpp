@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * spi-output-daemon-pi/spi-output-daemon.cpp
+ *
+ * Output daemon: maps the shared-memory frame ring written by a renderer with
+ * ShmStrip and drives an APA102 strip from it. Renderer and daemon can be
+ * restarted independently.
+ *
+ * Copyright (C) 2018 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the GNU General Public License v3.0
+ ******************************************************************************/
+
+#include <BlinkenAlgorithms/Porting/RaspberryPi.hpp>
+
+#include <BlinkenAlgorithms/Extra/RealTime.hpp>
+#include <BlinkenAlgorithms/Extra/ShmFrameRing.hpp>
+#include <BlinkenAlgorithms/Strip/PiSPI_APA102.hpp>
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace BlinkenAlgorithms;
+
+//! set by SIGINT and SIGTERM; Control.hpp declares g_terminate as bool
+static volatile sig_atomic_t s_terminate = 0;
+
+void signal_handler(int) {
+    s_terminate = 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = argc >= 2 ? argv[1] : "blinken-frames";
+    std::string spidev = argc >= 3 ? argv[2] : "/dev/spidev0.0";
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    // the ring reader feeds the SPI output thread
+    RealTime::configure_from_env(RealTime::Render);
+
+    ShmFrameRing ring;
+    while (!s_terminate) {
+        if (!ring.attach(name)) {
+            // wait for the renderer to create the ring
+            delay(500);
+            continue;
+        }
+        std::cerr << "attached to /dev/shm/" << name << " with "
+                  << ring.num_pixels() << " pixels" << std::endl;
+
+        PiSPI_APA102<> strip(spidev, ring.num_pixels(), /* cs_pin */ -1,
+                           /* async */ true);
+        std::vector<Color> frame(ring.num_pixels());
+
+        uint32_t last = 0;
+        size_t frames = 0;
+        while (!s_terminate) {
+            if (ring.stale()) {
+                std::cerr << "ring recreated, attaching again" << std::endl;
+                break;
+            }
+            if (!ring.wait(last, /* timeout_us */ 100000))
+                continue;
+
+            // frame numbers restart if the renderer was restarted
+            if (!ring.read(frame.data(), last))
+                continue;
+
+            strip.setPixels(0, frame.data(), frame.size());
+            strip.show();
+
+            if (++frames % 1000 == 0) {
+                std::cerr << frames << " frames, "
+                          << strip.skipped_frames() << " unchanged"
+                          << std::endl;
+            }
+        }
+
+        strip.clear();
+        strip.show();
+        strip.wait();
+    }
+
+    return 0;
+}
+
+/******************************************************************************/